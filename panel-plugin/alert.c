@@ -0,0 +1,228 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+	/* Alert rules over the statistics of each interval: a fixed array
+	   of rules compiled from the configuration, so that checking them
+	   costs a few comparisons per update */
+
+#include "alert.h"
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+
+enum {
+    /* Statistics */
+    S_UTIL,
+    S_AWAIT,
+    S_READ,
+    S_WRITE,
+    S_TOTAL,
+    S_RIOPS,
+    S_WIOPS,
+    S_IOPS,
+    S_QLEN,
+    S_METRIC,
+    NSTATISTICS
+};
+
+static const char *const m_apcStatistic[NSTATISTICS] = {
+    "util", "await", "read", "write", "total", "riops", "wiops", "iops",
+    "qlen", "metric"
+};
+
+	/**************************************************************/
+
+static const char *SkipBlanks (const char *p_pc)
+{
+    while (isspace ((unsigned char) *p_pc))
+	p_pc++;
+    return (p_pc);
+}				/* SkipBlanks() */
+
+
+static const char *ParseRule (const char *p_pc,
+			      struct alert_rule_t *p_poRule,
+			      const char **p_ppcError)
+	/* Parse one rule, up to ';' or the end of the text */
+	/* Return the end of the rule, NULL on error */
+{
+    char           *pcEnd;
+    double          r;
+    size_t          n;
+    int             i;
+
+    p_pc = SkipBlanks (p_pc);
+    for (i = 0; i < NSTATISTICS; i++) {
+	n = strlen (m_apcStatistic[i]);
+	if (!strncmp (p_pc, m_apcStatistic[i], n)
+	    && !isalnum ((unsigned char) p_pc[n]))
+	    break;
+    }
+    if (i == NSTATISTICS) {
+	*p_ppcError = "Unknown statistic";
+	return (NULL);
+    }
+    p_poRule->iStatistic = i;
+    p_pc = SkipBlanks (p_pc + n);
+    if ((*p_pc != '>') && (*p_pc != '<')) {
+	*p_ppcError = "Expected '>' or '<'";
+	return (NULL);
+    }
+    p_poRule->iSense = (*p_pc == '>') ? 1 : -1;
+    p_poRule->rThreshold = strtod (++p_pc, &pcEnd);
+    if (pcEnd == p_pc) {
+	*p_ppcError = "Expected a threshold";
+	return (NULL);
+    }
+    p_pc = SkipBlanks (pcEnd);
+    if (!strncmp (p_pc, "for", 3) && !isalnum ((unsigned char) p_pc[3])) {
+	p_pc += 3;
+	r = strtod (p_pc, &pcEnd);
+	if ((pcEnd == p_pc) || (r < 0) || (r > 86400)) {
+	    *p_ppcError = "Expected a duration in seconds";
+	    return (NULL);
+	}
+	p_poRule->iDuration_ns = (uint64_t) (r * 1e9);
+	p_pc = SkipBlanks (pcEnd);
+    }
+    if (*p_pc && (*p_pc != ';')) {
+	*p_ppcError = "Unexpected character";
+	return (NULL);
+    }
+    return (p_pc);
+}				/* ParseRule() */
+
+
+int AlertCompile (struct alerts_t *p_poAlerts, const char *p_pcRules,
+		  char *p_pcError, size_t p_iErrorSize)
+{
+    const char     *pc = p_pcRules, *pcEnd, *pcError = NULL;
+
+    memset (p_poAlerts, 0, sizeof (*p_poAlerts));
+    while (*(pc = SkipBlanks (pc))) {
+	if (*pc == ';') {	/* Empty rule */
+	    pc++;
+	    continue;
+	}
+	if (p_poAlerts->n == ALERT_MAX_RULES) {
+	    pcError = "Too many rules";
+	    break;
+	}
+	if (!(pcEnd = ParseRule (pc, p_poAlerts->aoRule + p_poAlerts->n,
+				 &pcError)))
+	    break;
+	p_poAlerts->n++;
+	pc = *pcEnd ? pcEnd + 1 : pcEnd;
+    }
+    if (pcError) {
+	snprintf (p_pcError, p_iErrorSize, "Rule %d: %s",
+		  p_poAlerts->n + 1, pcError);
+	memset (p_poAlerts, 0, sizeof (*p_poAlerts));
+	return (-1);
+    }
+    return (0);
+}				/* AlertCompile() */
+
+	/**************************************************************/
+
+void AlertReset (struct alerts_t *p_poAlerts)
+{
+    int             i;
+
+    for (i = 0; i < p_poAlerts->n; i++) {
+	p_poAlerts->aoRule[i].iSince_ns = 0;
+	p_poAlerts->aoRule[i].fFired = 0;
+    }
+}				/* AlertReset() */
+
+
+uint32_t AlertUpdate (struct alerts_t *p_poAlerts,
+		      const struct perfstats_t *p_poStats,
+		      const double *p_prMetric, uint64_t p_iNow_ns)
+{
+    struct alert_rule_t *poRule;
+    double          arValue[NSTATISTICS];
+    uint32_t        iFiring = 0;
+    int             i, fHolds;
+
+    arValue[S_UTIL] = p_poStats->arBusy[RW_DATA];
+    arValue[S_AWAIT] = p_poStats->rAwait_ms;
+    arValue[S_READ] = p_poStats->arPerf[R_DATA];
+    arValue[S_WRITE] = p_poStats->arPerf[W_DATA];
+    arValue[S_TOTAL] = p_poStats->arPerf[RW_DATA];
+    arValue[S_RIOPS] = p_poStats->arIops[R_DATA];
+    arValue[S_WIOPS] = p_poStats->arIops[W_DATA];
+    arValue[S_IOPS] = p_poStats->arIops[RW_DATA];
+    arValue[S_QLEN] = p_poStats->qlen;
+    arValue[S_METRIC] = p_prMetric ? *p_prMetric : 0;
+    for (i = 0; i < p_poAlerts->n; i++) {
+	poRule = p_poAlerts->aoRule + i;
+	poRule->rValue = arValue[poRule->iStatistic];
+	fHolds = (poRule->iSense > 0) ?
+	    (poRule->rValue > poRule->rThreshold) :
+	    (poRule->rValue < poRule->rThreshold);
+	/* Without the kernel busy times, or without a metric, the rules
+	   using them never hold */
+	if (!p_poStats->fBusyValid && ((poRule->iStatistic == S_UTIL)
+				     || (poRule->iStatistic == S_AWAIT)
+				     || (poRule->iStatistic == S_QLEN)))
+	    fHolds = 0;
+	if ((poRule->iStatistic == S_METRIC) && !p_prMetric)
+	    fHolds = 0;
+	if (!fHolds) {
+	    poRule->iSince_ns = 0;
+	    poRule->fFired = 0;
+	    continue;
+	}
+	if (!poRule->iSince_ns)
+	    /* The condition held over the whole interval */
+	    poRule->iSince_ns = p_iNow_ns - p_poStats->iInterval_ns;
+	if (poRule->fFired
+	    || (p_iNow_ns - poRule->iSince_ns < poRule->iDuration_ns)
+	    || (poRule->iNotified_ns
+		&& (p_iNow_ns - poRule->iNotified_ns < ALERT_REPEAT_NS)))
+	    continue;
+	poRule->fFired = 1;
+	poRule->iNotified_ns = p_iNow_ns;
+	iFiring |= 1u << i;
+    }
+    return (iFiring);
+}				/* AlertUpdate() */
+
+
+void AlertFormat (const struct alerts_t *p_poAlerts, int p_iRule,
+		  char *p_pcText, size_t p_iSize)
+{
+    const struct alert_rule_t *poRule = p_poAlerts->aoRule + p_iRule;
+    int             n;
+
+    n = snprintf (p_pcText, p_iSize, "%s %c %g",
+		  m_apcStatistic[poRule->iStatistic],
+		  (poRule->iSense > 0) ? '>' : '<', poRule->rThreshold);
+    if (poRule->iDuration_ns && (n >= 0) && ((size_t) n < p_iSize))
+	n += snprintf (p_pcText + n, p_iSize - n, " for %g s",
+		       poRule->iDuration_ns / 1e9);
+    if ((n >= 0) && ((size_t) n < p_iSize))
+	snprintf (p_pcText + n, p_iSize - n, " (%.1f)", poRule->rValue);
+}				/* AlertFormat() */
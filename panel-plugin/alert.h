@@ -0,0 +1,94 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef _alert_h
+#define _alert_h
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stddef.h>
+#include <inttypes.h>
+
+#include "perfstats.h"
+
+
+#define ALERT_MAX_RULES	8
+#define ALERT_REPEAT_NS	(300ull * 1000 * 1000 * 1000)
+/* Minimum time between two notifications of the same rule */
+
+ /* Alert rules, separated by ';':
+    rule := statistic ('>' | '<') number [ 'for' seconds ]
+    statistic := 'util' (%) | 'await' (ms) | 'read' | 'write' | 'total'
+		 (MiB/s) | 'riops' | 'wiops' | 'iops' | 'qlen'
+		 | 'metric' (the derived metric, see metric.h)
+    e.g. "util > 95 for 60; await > 50". A rule fires once its
+    condition held over all the intervals of the last <seconds> (at
+    once if omitted), and fires again only after the condition stopped
+    holding and at least ALERT_REPEAT_NS elapsed. */
+
+typedef struct alert_rule_t {
+    uint8_t         iStatistic;
+    int8_t          iSense;	/* 1: above the threshold, -1: below */
+    double          rThreshold;
+    uint64_t        iDuration_ns;
+    /* State */
+    uint64_t        iSince_ns;	/* Start of the condition, 0 if it does
+				   not hold */
+    uint64_t        iNotified_ns;	/* Last firing, 0 if none */
+    int             fFired;	/* Since the condition started */
+    double          rValue;	/* Last value of the statistic */
+} alert_rule_t;
+
+typedef struct alerts_t {
+    int             n;		/* Rules, 0 if none */
+    struct alert_rule_t
+                    aoRule[ALERT_MAX_RULES];
+} alerts_t;
+
+
+#ifdef __cplusplus
+extern          "C" {
+#endif
+
+    int             AlertCompile (struct alerts_t *alerts, const char *rules,
+				  char *error, size_t ErrorSize);
+    /* Parse rules into alerts - On error, describe it into
+       error[ErrorSize], and leave alerts empty */
+    /* Return 0 on success, -1 on error */
+
+    void            AlertReset (struct alerts_t *alerts);
+    /* The statistics were interrupted (baseline, device unavailable):
+       no condition holds any longer */
+
+    uint32_t        AlertUpdate (struct alerts_t *alerts,
+				 const struct perfstats_t *stats,
+				 const double *metric, uint64_t now_ns);
+    /* Check the rules against the statistics of the interval ending
+       at now_ns, and the derived metric unless metric is NULL */
+    /* Return the mask of the rules that fire now (bit i for rule i) */
+
+    void            AlertFormat (const struct alerts_t *alerts, int rule,
+				 char *text, size_t size);
+    /* Describe rule and its last value into text[size] */
+
+#ifdef __cplusplus
+}				/* extern "C" */
+#endif
+
+#endif				/* _alert_h */
@@ -0,0 +1,477 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+	/* Per control group I/O breakdown, from the cgroup2 io.stat
+	   files */
+
+#include "cgroupio.h"
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+
+#if defined(__linux__)
+	/**************************************************************/
+	/**************************	Linux	***********************/
+	/**************************************************************/
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <time.h>
+#ifdef HAVE_SYS_SYSMACROS_H
+#include <sys/sysmacros.h>
+#endif
+
+#define CGROUP2_ROOT	"/sys/fs/cgroup"
+#define MIN_ENTRIES	64
+
+
+static uint64_t Now_ns (void)
+{
+    struct timespec oNow;
+
+    clock_gettime (CLOCK_MONOTONIC, &oNow);
+    return ((uint64_t) 1000 * 1000 * 1000 * oNow.tv_sec + oNow.tv_nsec);
+}				/* Now_ns() */
+
+
+static dev_t WholeDisk (dev_t p_iDev)
+	/* The I/O controller accounts whole disks: map a partition to
+	   its parent through sysfs */
+{
+    char            acPath[64], acBuffer[32];
+    unsigned int    iMajor, iMinor;
+    ssize_t         n;
+    int             fd;
+
+    snprintf (acPath, sizeof (acPath), "/sys/dev/block/%u:%u/partition",
+	      major (p_iDev), minor (p_iDev));
+    if (access (acPath, F_OK))
+	return (p_iDev);
+    snprintf (acPath, sizeof (acPath), "/sys/dev/block/%u:%u/../dev",
+	      major (p_iDev), minor (p_iDev));
+    if ((fd = open (acPath, O_RDONLY | O_CLOEXEC)) == -1)
+	return (p_iDev);
+    n = read (fd, acBuffer, sizeof (acBuffer) - 1);
+    close (fd);
+    if (n <= 0)
+	return (p_iDev);
+    acBuffer[n] = 0;
+    if (sscanf (acBuffer, "%u:%u", &iMajor, &iMinor) != 2)
+	return (p_iDev);
+    return (makedev (iMajor, iMinor));
+}				/* WholeDisk() */
+
+
+static void CloseEntry (struct cgroupio_entry_t *p_poEntry)
+{
+    if (p_poEntry->iStatFd != -1)
+	close (p_poEntry->iStatFd);
+    free (p_poEntry->pcPath);
+    memset (p_poEntry, 0, sizeof (*p_poEntry));
+    p_poEntry->iStatFd = -1;
+}				/* CloseEntry() */
+
+
+static DIR     *OpenDir (int p_iRootFd, const char *p_pcPath)
+	/* Open the directory of a control group, for the walk only */
+{
+    DIR            *poDir;
+    int             fd;
+
+    fd = openat (p_iRootFd, (*p_pcPath ? p_pcPath : "."),
+		 O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd == -1)
+	return (0);
+    if (!(poDir = fdopendir (fd)))
+	close (fd);
+    return (poDir);
+}				/* OpenDir() */
+
+
+static int OpenStat (int p_iRootFd, const char *p_pcPath)
+	/* Return the io.stat descriptor of a control group, -1 if none
+	   (the root group has no io.stat on older kernels) */
+{
+    char            acPath[4096];
+
+    if (snprintf (acPath, sizeof (acPath), "%s%sio.stat", p_pcPath,
+		  (*p_pcPath ? "/" : "")) >= (int) sizeof (acPath))
+	return (-1);
+    return (openat (p_iRootFd, acPath, O_RDONLY | O_CLOEXEC));
+}				/* OpenStat() */
+
+
+static int ComparePaths (const void *p_pv1, const void *p_pv2)
+{
+    return (strcmp (((const struct cgroupio_entry_t *) p_pv1)->pcPath,
+		    ((const struct cgroupio_entry_t *) p_pv2)->pcPath));
+}				/* ComparePaths() */
+
+
+static struct cgroupio_entry_t *Lookup (struct cgroupio_entry_t
+					*p_aoEntry, size_t p_n,
+					const char *p_pcPath)
+	/* Among the entries of the previous walk */
+{
+    struct cgroupio_entry_t oKey;
+
+    if (!p_n)
+	return (0);
+    oKey.pcPath = (char *) p_pcPath;
+    return (bsearch (&oKey, p_aoEntry, p_n, sizeof (oKey), ComparePaths));
+}				/* Lookup() */
+
+
+static int AddEntry (struct cgroupio_entry_t **p_paoNew, size_t *p_pn,
+		     size_t *p_piSize, struct cgroupio_entry_t *p_aoOld,
+		     size_t p_nOld, char *p_afTaken, char *p_pcPath)
+	/* Append a group to the table being built, taking over its
+	   previous entry if any; takes ownership of p_pcPath */
+{
+    struct cgroupio_entry_t *poEntry, *poOld;
+
+    if (*p_pn == *p_piSize) {
+	poEntry = realloc (*p_paoNew, 2 * *p_piSize * sizeof (*poEntry));
+	if (!poEntry) {
+	    free (p_pcPath);
+	    return (-1);
+	}
+	*p_paoNew = poEntry;
+	*p_piSize *= 2;
+    }
+    poEntry = *p_paoNew + *p_pn;
+    if ((poOld = Lookup (p_aoOld, p_nOld, p_pcPath))) {
+	*poEntry = *poOld;
+	p_afTaken[poOld - p_aoOld] = 1;
+	free (p_pcPath);
+    }
+    else {
+	memset (poEntry, 0, sizeof (*poEntry));
+	poEntry->pcPath = p_pcPath;
+	poEntry->iStatFd = -1;
+    }
+    (*p_pn)++;
+    return (0);
+}				/* AddEntry() */
+
+
+static int Walk (struct cgroupio_t *p_poCgroupIo)
+	/* Rebuild the table from the hierarchy, breadth first, reusing the
+	   descriptors (and counters) of the groups already known - Only
+	   the io.stat descriptors of the first CGROUPIO_MAX_OPEN groups
+	   are kept: a host with thousands of groups must not run the
+	   panel out of descriptors */
+{
+    struct cgroupio_entry_t *aoOld = p_poCgroupIo->aoEntry, *aoNew;
+    struct cgroupio_entry_t oKey, *poParent;
+    size_t          nOld = p_poCgroupIo->n, n = 0, iSize, i;
+    struct dirent  *poDirEntry;
+    const char     *pcParent;
+    char           *afTaken, *pcPath, *pc, acParent[4096];
+    DIR            *poDir;
+    int             status = 0, nOpen = 0;
+
+    iSize = (p_poCgroupIo->iSize ? p_poCgroupIo->iSize : MIN_ENTRIES);
+    aoNew = malloc (iSize * sizeof (*aoNew));
+    afTaken = calloc (nOld + 1, 1);
+    pcPath = strdup ("");
+    if (!aoNew || !afTaken || !pcPath) {
+	free (aoNew);
+	free (afTaken);
+	free (pcPath);
+	return (-1);
+    }
+    status = AddEntry (&aoNew, &n, &iSize, aoOld, nOld, afTaken, pcPath);
+    for (i = 0; (i < n) && !status; i++) {
+	if (!(poDir = OpenDir (p_poCgroupIo->iRootFd, aoNew[i].pcPath)))
+	    continue;		/* Vanished meanwhile */
+	pcParent = aoNew[i].pcPath;
+	while ((poDirEntry = readdir (poDir)) && !status) {
+	    if ((poDirEntry->d_type != DT_DIR)
+		|| !strcmp (poDirEntry->d_name, ".")
+		|| !strcmp (poDirEntry->d_name, ".."))
+		continue;
+	    pcPath = malloc (strlen (pcParent) + strlen (poDirEntry->d_name)
+			     + 2);
+	    if (!pcPath) {
+		status = -1;
+		break;
+	    }
+	    sprintf (pcPath, "%s%s%s", pcParent, (*pcParent ? "/" : ""),
+		     poDirEntry->d_name);
+	    status = AddEntry (&aoNew, &n, &iSize, aoOld, nOld, afTaken,
+			       pcPath);
+	    pcParent = aoNew[i].pcPath;	/* aoNew may have moved */
+	}
+	closedir (poDir);
+    }
+    for (i = 0; i < nOld; i++)
+	if (!afTaken[i])
+	    CloseEntry (aoOld + i);
+    free (afTaken);
+    free (aoOld);
+    qsort (aoNew, n, sizeof (*aoNew), ComparePaths);
+    for (i = 0; i < n; i++)
+	nOpen += (aoNew[i].iStatFd != -1);
+    for (i = 0; i < n; i++) {
+	if ((aoNew[i].iStatFd == -1) && (nOpen < CGROUPIO_MAX_OPEN)
+	    && ((aoNew[i].iStatFd = OpenStat (p_poCgroupIo->iRootFd,
+					      aoNew[i].pcPath)) != -1))
+	    nOpen++;
+	/* Parent: the path up to its last '/', or the root */
+	aoNew[i].iParent = -1;
+	if (!*(aoNew[i].pcPath))
+	    continue;
+	if ((pc = strrchr (aoNew[i].pcPath, '/'))) {
+	    if (pc - aoNew[i].pcPath >= (int) sizeof (acParent))
+		continue;
+	    memcpy (acParent, aoNew[i].pcPath, pc - aoNew[i].pcPath);
+	    acParent[pc - aoNew[i].pcPath] = 0;
+	    oKey.pcPath = acParent;
+	    poParent = bsearch (&oKey, aoNew, n, sizeof (oKey), ComparePaths);
+	}
+	else
+	    poParent = (*(aoNew[0].pcPath) ? 0 : aoNew);
+	if (poParent)
+	    aoNew[i].iParent = poParent - aoNew;
+    }
+    p_poCgroupIo->aoEntry = aoNew;
+    p_poCgroupIo->n = n;
+    p_poCgroupIo->iSize = iSize;
+    return (status);
+}				/* Walk() */
+
+
+static void ParseStat (const char *p_pcKey, size_t p_iKeyLength,
+		       struct cgroupio_entry_t *p_poEntry,
+		       const struct kread_t *p_poRead)
+	/* Pick the line of the device out of io.stat:
+	   "MAJ:MIN rbytes=... wbytes=... rios=... wios=... ..." */
+{
+    static const char *const apcName[CGROUPIO_NCOUNTERS] = {
+	"rbytes=", "wbytes=", "rios=", "wios="
+    };
+    uint64_t        aiCounter[CGROUPIO_NCOUNTERS];
+    char           *pcLine, *pc;
+    int             i, fValid = p_poEntry->fValid;
+
+    p_poEntry->fValid = 0;
+    memset (p_poEntry->aiDelta, 0, sizeof (p_poEntry->aiDelta));
+    if ((p_poRead->iFd == -1) || !p_poRead->fReady)
+	return;			/* Group removed */
+    memset (aiCounter, 0, sizeof (aiCounter));
+    for (pcLine = p_poRead->pcBuffer; pcLine && *pcLine;
+	 pcLine = ((pc = strchr (pcLine, '\n')) ? pc + 1 : 0)) {
+	if (strncmp (pcLine, p_pcKey, p_iKeyLength))
+	    continue;
+	for (pc = pcLine + p_iKeyLength; *pc && (*pc != '\n');) {
+	    for (i = 0; i < CGROUPIO_NCOUNTERS; i++)
+		if (!strncmp (pc, apcName[i], strlen (apcName[i]))) {
+		    aiCounter[i] = strtoull (pc + strlen (apcName[i]), &pc,
+					     10);
+		    break;
+		}
+	    while (*pc && (*pc != ' ') && (*pc != '\n'))
+		pc++;
+	    while (*pc == ' ')
+		pc++;
+	}
+	break;
+    }
+    /* No line: the group has not touched the device yet */
+    for (i = 0; i < CGROUPIO_NCOUNTERS; i++) {
+	if (fValid && (aiCounter[i] >= p_poEntry->aiCounter[i]))
+	    p_poEntry->aiDelta[i] = aiCounter[i] - p_poEntry->aiCounter[i];
+	p_poEntry->aiCounter[i] = aiCounter[i];
+    }
+    p_poEntry->fValid = 1;
+}				/* ParseStat() */
+
+
+int CgroupIoOpen (struct cgroupio_t *p_poCgroupIo, dev_t p_iDev,
+		  int p_fRing)
+{
+    int             i;
+
+    memset (p_poCgroupIo, 0, sizeof (*p_poCgroupIo));
+    KReadInit (&(p_poCgroupIo->oBatch), 0);
+    p_poCgroupIo->iRootFd =
+	open (CGROUP2_ROOT, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (p_poCgroupIo->iRootFd == -1)
+	return (-1);
+    if (faccessat (p_poCgroupIo->iRootFd, "cgroup.controllers", F_OK, 0)) {
+	/* cgroup v1 (or hybrid) layout */
+	close (p_poCgroupIo->iRootFd);
+	p_poCgroupIo->iRootFd = -1;
+	return (-1);
+    }
+    p_poCgroupIo->pcBuffers = malloc (KREAD_MAX * CGROUPIO_STAT_SIZE);
+    if (!p_poCgroupIo->pcBuffers) {
+	CgroupIoClose (p_poCgroupIo);
+	return (-1);
+    }
+    for (i = 0; i < KREAD_MAX; i++) {
+	p_poCgroupIo->aoRead[i].pcBuffer =
+	    p_poCgroupIo->pcBuffers + i * CGROUPIO_STAT_SIZE;
+	p_poCgroupIo->aoRead[i].iSize = CGROUPIO_STAT_SIZE;
+    }
+    KReadInit (&(p_poCgroupIo->oBatch), p_fRing);
+    p_iDev = WholeDisk (p_iDev);
+    p_poCgroupIo->iKeyLength =
+	snprintf (p_poCgroupIo->acKey, sizeof (p_poCgroupIo->acKey),
+		  "%u:%u ", major (p_iDev), minor (p_iDev));
+    return (0);
+}				/* CgroupIoOpen() */
+
+
+void CgroupIoClose (struct cgroupio_t *p_poCgroupIo)
+{
+    size_t          i;
+
+    for (i = 0; i < p_poCgroupIo->n; i++)
+	CloseEntry (p_poCgroupIo->aoEntry + i);
+    free (p_poCgroupIo->aoEntry);
+    KReadClose (&(p_poCgroupIo->oBatch));
+    free (p_poCgroupIo->pcBuffers);
+    if (p_poCgroupIo->iRootFd != -1)
+	close (p_poCgroupIo->iRootFd);
+    memset (p_poCgroupIo, 0, sizeof (*p_poCgroupIo));
+    KReadInit (&(p_poCgroupIo->oBatch), 0);
+    p_poCgroupIo->iRootFd = -1;
+}				/* CgroupIoClose() */
+
+
+int CgroupIoScan (struct cgroupio_t *p_poCgroupIo)
+{
+    struct cgroupio_entry_t *poEntry, *poParent;
+    struct kread_t *poRead;
+    uint64_t        iNow_ns;
+    size_t          i, j;
+    int             k;
+
+    if (p_poCgroupIo->iRootFd == -1)
+	return (-1);
+    if (!(p_poCgroupIo->iScans++ % CGROUPIO_RESCAN))
+	(void) Walk (p_poCgroupIo);
+    iNow_ns = Now_ns ();
+    for (i = 0; i < p_poCgroupIo->n; i += KREAD_MAX) {
+	/* One batch of reads per KREAD_MAX groups */
+	KReadReset (&(p_poCgroupIo->oBatch));
+	for (j = 0; (j < KREAD_MAX) && (i + j < p_poCgroupIo->n); j++) {
+	    poEntry = p_poCgroupIo->aoEntry + i + j;
+	    poRead = p_poCgroupIo->aoRead + j;
+	    poRead->iFd = (poEntry->iStatFd != -1) ? poEntry->iStatFd :
+		OpenStat (p_poCgroupIo->iRootFd, poEntry->pcPath);
+	    KReadAdd (&(p_poCgroupIo->oBatch), poRead);
+	}
+	KReadSubmit (&(p_poCgroupIo->oBatch));
+	for (j = 0; (j < KREAD_MAX) && (i + j < p_poCgroupIo->n); j++) {
+	    poEntry = p_poCgroupIo->aoEntry + i + j;
+	    poRead = p_poCgroupIo->aoRead + j;
+	    ParseStat (p_poCgroupIo->acKey, p_poCgroupIo->iKeyLength,
+		       poEntry, poRead);
+	    if ((poEntry->iStatFd == -1) && (poRead->iFd != -1))
+		close (poRead->iFd);
+	}
+    }
+    /* What each group did by itself: io.stat includes the descendants */
+    for (i = 0; i < p_poCgroupIo->n; i++)
+	memcpy (p_poCgroupIo->aoEntry[i].aiOwn,
+		p_poCgroupIo->aoEntry[i].aiDelta,
+		sizeof (p_poCgroupIo->aoEntry[i].aiOwn));
+    for (i = 0; i < p_poCgroupIo->n; i++) {
+	poEntry = p_poCgroupIo->aoEntry + i;
+	if (poEntry->iParent < 0)
+	    continue;
+	poParent = p_poCgroupIo->aoEntry + poEntry->iParent;
+	for (k = 0; k < CGROUPIO_NCOUNTERS; k++)
+	    /* Not read at the same instant: never below 0 */
+	    poParent->aiOwn[k] = (poParent->aiOwn[k] > poEntry->aiDelta[k]) ?
+		poParent->aiOwn[k] - poEntry->aiDelta[k] : 0;
+    }
+    p_poCgroupIo->iInterval_ns =
+	(p_poCgroupIo->iTimestamp_ns ?
+	 iNow_ns - p_poCgroupIo->iTimestamp_ns : 0);
+    p_poCgroupIo->iTimestamp_ns = iNow_ns;
+    return (p_poCgroupIo->n);
+}				/* CgroupIoScan() */
+
+#else
+	/**************************************************************/
+	/********************	Unsupported platform	***************/
+	/**************************************************************/
+
+int CgroupIoOpen (struct cgroupio_t *p_poCgroupIo, dev_t p_iDev,
+		  int p_fRing)
+{
+    memset (p_poCgroupIo, 0, sizeof (*p_poCgroupIo));
+    KReadInit (&(p_poCgroupIo->oBatch), 0);
+    p_poCgroupIo->iRootFd = -1;
+    return (-1);
+}				/* CgroupIoOpen() */
+
+
+void CgroupIoClose (struct cgroupio_t *p_poCgroupIo)
+{
+}				/* CgroupIoClose() */
+
+
+int CgroupIoScan (struct cgroupio_t *p_poCgroupIo)
+{
+    return (-1);
+}				/* CgroupIoScan() */
+
+#endif
+
+
+int CgroupIoTop (const struct cgroupio_t *p_poCgroupIo,
+		 const struct cgroupio_entry_t **p_ppoTop, int p_n)
+	/* Partial insertion sort, as ProcIoTop() */
+{
+    const struct cgroupio_entry_t *poEntry;
+    uint64_t        iBytes;
+    size_t          i;
+    int             n = 0, j;
+
+    for (i = 0; i < p_poCgroupIo->n; i++) {
+	poEntry = p_poCgroupIo->aoEntry + i;
+	if (!*(poEntry->pcPath))
+	    continue;		/* Root: the device totals */
+	iBytes = poEntry->aiOwn[CG_RBYTES] + poEntry->aiOwn[CG_WBYTES];
+	if (!iBytes)
+	    continue;
+	for (j = n; j > 0; j--) {
+	    if (p_ppoTop[j - 1]->aiOwn[CG_RBYTES] +
+		p_ppoTop[j - 1]->aiOwn[CG_WBYTES] >= iBytes)
+		break;
+	    if (j < p_n)
+		p_ppoTop[j] = p_ppoTop[j - 1];
+	}
+	if (j < p_n) {
+	    p_ppoTop[j] = poEntry;
+	    if (n < p_n)
+		n++;
+	}
+    }
+    return (n);
+}				/* CgroupIoTop() */
@@ -0,0 +1,114 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _cgroupio_h
+#define _cgroupio_h
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <sys/types.h>
+
+#include "kread.h"
+
+
+#define CGROUPIO_RESCAN	10	/* Scans between two hierarchy walks */
+#define CGROUPIO_STAT_SIZE	4096	/* io.stat read buffer */
+#define CGROUPIO_MAX_OPEN	256
+/* io.stat files kept open; those of the other groups are opened at
+   each scan */
+
+typedef enum cgroupio_counter_t {
+    CG_RBYTES,
+    CG_WBYTES,
+    CG_RIOS,
+    CG_WIOS,
+    CGROUPIO_NCOUNTERS
+} cgroupio_counter_t;
+
+typedef struct cgroupio_entry_t {
+    /* io.stat of a single control group, for the monitored device */
+    char           *pcPath;	/* Relative to the cgroup2 mount point */
+    int             iParent;	/* Index of the parent group, -1 for the
+				   root */
+    int             iStatFd;	/* Cached io.stat file descriptor, -1 if
+				   not cached */
+    int             fValid;	/* Counters read by the last scan */
+    uint64_t        aiCounter[CGROUPIO_NCOUNTERS];
+    uint64_t        aiDelta[CGROUPIO_NCOUNTERS];	/* Last interval,
+							   descendants
+							   included */
+    uint64_t        aiOwn[CGROUPIO_NCOUNTERS];	/* Last interval, less
+						   what the child groups
+						   did */
+} cgroupio_entry_t;
+
+typedef struct cgroupio_t {
+    int             iRootFd;	/* cgroup2 mount point */
+    char            acKey[32];	/* "MAJ:MIN " io.stat line prefix */
+    size_t          iKeyLength;
+    struct cgroupio_entry_t
+                   *aoEntry;	/* Sorted by path; root first */
+    size_t          n;
+    size_t          iSize;
+    unsigned int    iScans;
+    struct kreadbatch_t
+                    oBatch;	/* io.stat reads, KREAD_MAX at a time */
+    struct kread_t  aoRead[KREAD_MAX];
+    char           *pcBuffers;	/* KREAD_MAX * CGROUPIO_STAT_SIZE */
+    uint64_t        iTimestamp_ns;	/* Time of the last scan */
+    uint64_t        iInterval_ns;	/* Time between the last two scans */
+} cgroupio_t;
+
+
+#ifdef __cplusplus
+extern          "C" {
+#endif
+
+    int             CgroupIoOpen (struct cgroupio_t *cgroupio, dev_t dev,
+				  int ring);
+    /* Prepare the io.stat collector for device dev (a partition stands
+       for its whole disk, which is what the I/O controller accounts),
+       batching the reads through io_uring if ring is set (see
+       kread.h) */
+    /* Return 0 on success, -1 if there is no cgroup2 hierarchy */
+
+    void            CgroupIoClose (struct cgroupio_t *cgroupio);
+    /* Release every cached descriptor */
+
+    int             CgroupIoScan (struct cgroupio_t *cgroupio);
+    /* Read io.stat of every control group and compute the deltas since
+       the previous scan; the hierarchy itself is walked again every
+       CGROUPIO_RESCAN scans only */
+    /* Return the number of control groups, -1 on error */
+
+    int             CgroupIoTop (const struct cgroupio_t *cgroupio,
+				 const struct cgroupio_entry_t **top, int n);
+    /* Get the n control groups (root excluded) that transferred the
+       most bytes on the device by themselves (aiOwn) during the last
+       interval, most active first - io.stat counts the descendants
+       too: ranking that would list each group with its parents */
+    /* Return the number of control groups stored into top */
+
+#ifdef __cplusplus
+}				/* extern "C" */
+#endif
+
+#endif				/* _cgroupio_h */
@@ -19,6 +19,7 @@
 
 
 #include "devperf.h"
+#include "kread.h"
 
 
 #ifdef HAVE_CONFIG_H
@@ -39,6 +40,58 @@
 #include <sys/sysmacros.h>
 #endif
 #include <sys/types.h>
+#include <fcntl.h>
+#include <time.h>
+
+#if defined(__GNUC__) && defined(__x86_64__) && defined(__SSE2__)
+#define SCAN_SSE2	1	/* Vectorised line scanner */
+#include <immintrin.h>
+#if (__GNUC__ >= 5) || defined(__clang__)
+#define SCAN_AVX2	1	/* Selected at run time */
+#endif
+#endif
+
+
+static struct devperf_cost_t m_oCost;	/* Cost of the last collection */
+static int      m_fCost = 0;		/* Cost accounting enabled */
+
+static uint64_t Now_ns (void)
+{
+    struct timespec oNow;
+
+    clock_gettime (CLOCK_MONOTONIC, &oNow);
+    return ((uint64_t) 1000 * 1000 * 1000 * oNow.tv_sec + oNow.tv_nsec);
+}				/* Now_ns() */
+
+static uint64_t Timestamp_ns (void)
+	/* Time of a sample */
+{
+    struct timespec oNow;
+
+    clock_gettime (DEVPERF_CLOCK, &oNow);
+    return ((uint64_t) 1000 * 1000 * 1000 * oNow.tv_sec + oNow.tv_nsec);
+}				/* Timestamp_ns() */
+
+
+#if defined(__NetBSD__) || defined(__OpenBSD__)
+static void    *m_pvSysctlBuffer = 0;	/* Grows, never shrinks */
+static size_t   m_iSysctlBufferSize = 0;
+
+static void    *SysctlBuffer (size_t p_iSize)
+	/* Buffer for the disk statistics, reused from one call to the
+	   next so that collecting does not allocate */
+{
+    void           *pv;
+
+    if (p_iSize > m_iSysctlBufferSize) {
+	if (!(pv = realloc (m_pvSysctlBuffer, p_iSize)))
+	    return (0);
+	m_pvSysctlBuffer = pv;
+	m_iSysctlBufferSize = p_iSize;
+    }
+    return (m_pvSysctlBuffer);
+}				/* SysctlBuffer() */
+#endif
 
 
 #if defined(__linux__)
@@ -51,10 +104,22 @@ static const char STATISTICS_FILE_1[] = "/proc/diskstats";	/* Kernel
 static const char STATISTICS_FILE_2[] = "/proc/partitions";	/* Kernel
 								   2.4 */
 
-static const uint64_t SECTOR_SIZE = 512;
+static const uint64_t SECTOR_SIZE = 512;	/* The kernel counts 512-byte
+						   units whatever the logical
+						   block size of the device */
 
 static int      m_iInitStatus = 0;
 static const char *m_pcStatFile = 0;
+static char     m_acStatFile[256];	/* Alternate statistics file */
+
+static char    *m_pcBuffer = 0;		/* Statistics file contents */
+static size_t   m_iBufferSize = 0, m_iLength = 0;
+static struct kread_t m_oStatRead = { .iFd = -1 };	/* Persistent descriptor of
+						   the statistics file */
+
+#define SCAN_PADDING	64	/* Zeroed bytes kept past the end of the
+				   statistics, so that the scanner may load
+				   whole vectors */
 
 typedef int     (*GetPerfData_t) (dev_t dev, struct devperf_t * perf);
 
@@ -62,134 +127,583 @@ static GetPerfData_t m_mGetPerfData = 0;
 
 	/**************************************************************/
 
-static int DevGetPerfData1 (dev_t p_iDevice, struct devperf_t *p_poPerf)
-	/* Get disk performance statistics from STATISTICS_FILE_1 */
+static int GrowBuffer (void)
+	/* Double the size of m_pcBuffer, keeping its contents */
+	/* Return 0 on success, -1 otherwise */
 {
-    const int       iMajorNo = major(p_iDevice),
-	iMinorNo = minor(p_iDevice);
-    struct timeval  oTimeStamp;
-    FILE           *pF;
-    unsigned int    major, minor, rsect, wsect, ruse, wuse, use;
-    int             running;
-    char            acStats[128];
-    int             c, n;
-
-    pF = fopen (STATISTICS_FILE_1, "r");
-    if (!pF) {
-	perror (STATISTICS_FILE_1);
+    const size_t    iSize = m_iBufferSize ? 2 * m_iBufferSize : 16 * 1024;
+    char           *pc = realloc (m_pcBuffer, iSize);
+
+    if (!pc)
+	return (-1);
+    m_pcBuffer = pc;
+    m_iBufferSize = iSize;
+    m_oStatRead.pcBuffer = m_pcBuffer;
+    m_oStatRead.iSize = m_iBufferSize - SCAN_PADDING;
+    return (0);
+}				/* GrowBuffer() */
+
+
+static int ReadStatFile (void)
+	/* Read the whole statistics file into m_pcBuffer, NUL-terminated,
+	   unless a batch (see DevPerfKRead()) did it already. The buffer
+	   only grows, so that no allocation occurs once it fits the
+	   file */
+	/* Return 0 on success, -1 otherwise */
+{
+    const uint64_t  t0 = m_fCost ? Now_ns () : 0;
+    size_t          iRequest;
+    ssize_t         n;
+    int             fMore = 1;
+
+    m_iLength = 0;
+    if (m_oStatRead.iFd == -1)
 	return (-1);
+    if (m_oStatRead.fReady) {
+	m_oStatRead.fReady = 0;
+	m_iLength = m_oStatRead.iLength;
+	fMore = (m_iLength == m_oStatRead.iSize - 1);
     }
-    while (1) {
-	n = fscanf (pF, "%u %u", &major, &minor);
-	if (n != 2)
-	    goto Error;
-	if ((major != iMajorNo) || (minor != iMinorNo)) {
-	    while ((c = fgetc (pF)) && (c != '\n'));	/* Goto next line */
-	    continue;
+    while (fMore) {
+	if ((m_iBufferSize - m_iLength < SCAN_PADDING + 2) && GrowBuffer ())
+	    return (-1);
+	iRequest = m_iBufferSize - m_iLength - SCAN_PADDING - 1;
+	n = pread (m_oStatRead.iFd, m_pcBuffer + m_iLength, iRequest,
+		   m_iLength);
+	m_oCost.syscalls++;
+	if (n == -1) {
+	    if (errno == EINTR)
+		continue;
+	    perror (m_pcStatFile);
+	    return (-1);
 	}
-	fscanf (pF, "%*s");	/* Skip device name */
-	/* Read rest of line into acStats */
-	if (!(fgets (acStats, sizeof (acStats), pF)))
-	    goto Error;
-	n = sscanf (acStats,
-		    "%*u %*u %u %u %*u %*u %u %u %d %u %*u",
-		    &rsect, &ruse, &wsect, &wuse, &running, &use);
-	if (n != 6) {
-	    /* Not a full-statistics line */
-	    n = sscanf (acStats, "%*u %u %*u %u", &rsect, &wsect);
-	    if (n != 2)
-		goto Error;
-	    running = -1, ruse = wuse = 0;
+	m_iLength += n;
+	/* A short read means the end of the file */
+	fMore = ((size_t) n == iRequest);
+    }
+    if (m_fCost)
+	m_oCost.read_ns = Now_ns () - t0;
+    memset (m_pcBuffer + m_iLength, 0, SCAN_PADDING + 1);
+    return (0);
+}				/* ReadStatFile() */
+
+
+static const char *NextLine (const char *p_pc)
+	/* Return the beginning of the line following p_pc */
+{
+    const char     *pc = memchr (p_pc, '\n', m_pcBuffer + m_iLength - p_pc);
+    return (pc ? pc + 1 : m_pcBuffer + m_iLength);
+}				/* NextLine() */
+
+
+static const char *ParseNumber (const char *p_pc, uint64_t *p_piValue)
+	/* Parse an unsigned decimal number, skipping the leading blanks */
+	/* Return a pointer past the number, NULL if there is none on the
+	   line */
+{
+    uint64_t        i = 0;
+
+    while ((*p_pc == ' ') || (*p_pc == '\t'))
+	p_pc++;
+    if ((*p_pc < '0') || (*p_pc > '9'))
+	return (0);
+    for (; (*p_pc >= '0') && (*p_pc <= '9'); p_pc++)
+	i = 10 * i + (*p_pc - '0');
+    *p_piValue = i;
+    return (p_pc);
+}				/* ParseNumber() */
+
+
+static const char *SkipWord (const char *p_pc)
+	/* Skip a blank-separated word (e.g. device name) */
+{
+    while ((*p_pc == ' ') || (*p_pc == '\t'))
+	p_pc++;
+    while (*p_pc && (*p_pc != ' ') && (*p_pc != '\t') && (*p_pc != '\n'))
+	p_pc++;
+    return (p_pc);
+}				/* SkipWord() */
+
+
+enum {
+    /* Statistics fields following the device name */
+    F_RIO, F_RMERGE, F_RSECT, F_RUSE,
+    F_WIO, F_WMERGE, F_WSECT, F_WUSE,
+    F_RUNNING, F_USE, F_AVEQ,
+    NFIELDS
+};
+
+static int ParseFields (const char *p_pc, uint64_t *p_aiField)
+	/* Parse the statistics fields up to the end of the line */
+	/* Return the number of fields parsed */
+{
+    int             n;
+
+    for (n = 0; n < NFIELDS; n++)
+	if (!(p_pc = ParseNumber (p_pc, p_aiField + n)))
+	    break;
+    return (n);
+}				/* ParseFields() */
+
+
+static void StorePerf (const uint64_t *p_aiField, int p_fFull,
+		       struct devperf_t *p_poPerf)
+	/* Convert the statistics fields into performance data */
+{
+    p_poPerf->timestamp_ns = Timestamp_ns ();
+    if (p_fFull) {
+	p_poPerf->rbytes = SECTOR_SIZE * p_aiField[F_RSECT];
+	p_poPerf->wbytes = SECTOR_SIZE * p_aiField[F_WSECT];
+	p_poPerf->qlen = (int32_t) p_aiField[F_RUNNING];
+	p_poPerf->rbusy_ns = (uint64_t) 1000 *1000 * p_aiField[F_RUSE];
+	p_poPerf->wbusy_ns = (uint64_t) 1000 *1000 * p_aiField[F_WUSE];
+	p_poPerf->rios = p_aiField[F_RIO];
+	p_poPerf->wios = p_aiField[F_WIO];
+    }
+    else {
+	/* Partition line of kernels < 2.6.25: rio rsect wio wsect */
+	p_poPerf->rbytes = SECTOR_SIZE * p_aiField[1];
+	p_poPerf->wbytes = SECTOR_SIZE * p_aiField[3];
+	p_poPerf->qlen = -1;
+	p_poPerf->rbusy_ns = p_poPerf->wbusy_ns = 0;
+	p_poPerf->rios = p_aiField[0];
+	p_poPerf->wios = p_aiField[2];
+    }
+}				/* StorePerf() */
+
+	/**************************************************************/
+
+	/* /proc/diskstats lines start with the device numbers printed as
+	   "%4u %7u ", i.e. a 13-byte prefix. The scanner walks the
+	   newlines a vector at a time and compares the prefix of every
+	   line with the one of the wanted device in a single vector
+	   compare, so that the other lines are skipped without being
+	   parsed. A line is only handed over to the scalar parser when
+	   its prefix matches, or when it is not in that fixed-width form
+	   (e.g. an alternate statistics file). */
+
+#define PREFIX_LENGTH	13
+
+typedef struct prefix_t {
+    dev_t           dev;
+    int             fFixed;	/* Device numbers fit the fixed width */
+    char            acPrefix[16];	/* "%4u %7u " of the device */
+} prefix_t;
+
+typedef const char *(*ScanLines_t) (const char *p_pc, const char *p_pcEnd,
+				    const struct prefix_t * p_poPrefix);
+
+static struct prefix_t m_oPrefix;	/* Prefix of the last device */
+
+
+static const struct prefix_t *DevicePrefix (dev_t p_iDevice)
+	/* Return the line prefix of p_iDevice */
+{
+    const unsigned  iMajorNo = major(p_iDevice), iMinorNo = minor(p_iDevice);
+
+    if (m_oPrefix.fFixed && (m_oPrefix.dev == p_iDevice))
+	return (&m_oPrefix);
+    memset (&m_oPrefix, 0, sizeof (m_oPrefix));
+    m_oPrefix.dev = p_iDevice;
+    m_oPrefix.fFixed = (iMajorNo <= 9999) && (iMinorNo <= 9999999);
+    if (m_oPrefix.fFixed)
+	snprintf (m_oPrefix.acPrefix, sizeof (m_oPrefix.acPrefix),
+		  "%4u %7u ", iMajorNo, iMinorNo);
+    return (&m_oPrefix);
+}				/* DevicePrefix() */
+
+
+static int FixedField (const char *p_pc, int p_iWidth)
+	/* Tell whether the p_iWidth bytes at p_pc are a right-aligned
+	   number followed by a blank */
+{
+    int             i = 0;
+
+    while ((i < p_iWidth - 1) && (p_pc[i] == ' '))
+	i++;
+    if (i == p_iWidth - 1)
+	return (0);
+    for (; i < p_iWidth - 1; i++)
+	if ((p_pc[i] < '0') || (p_pc[i] > '9'))
+	    return (0);
+    return (p_pc[i] == ' ');
+}				/* FixedField() */
+
+
+static const char *ScanLinesScalar (const char *p_pc, const char *p_pcEnd,
+				    const struct prefix_t *p_poPrefix)
+	/* Return the first line, starting from p_pc, that has to be
+	   parsed, p_pcEnd if none: a line printed with the fixed-width
+	   "%4u %7u " of another device is skipped - Without a fixed-width
+	   prefix every line is a candidate */
+{
+    if (!p_poPrefix->fFixed)
+	return (p_pc);
+    for (; p_pc < p_pcEnd; p_pc = NextLine (p_pc))
+	if ((p_pcEnd - p_pc < PREFIX_LENGTH)
+	    || !memcmp (p_pc, p_poPrefix->acPrefix, PREFIX_LENGTH)
+	    || !FixedField (p_pc, 5) || !FixedField (p_pc + 5, 8))
+	    return (p_pc);
+    return (p_pcEnd);
+}				/* ScanLinesScalar() */
+
+
+#if defined(SCAN_SSE2)
+static inline int FixedWidth (unsigned p_iBlanks, unsigned p_iDigits)
+	/* Tell whether the space and digit masks of a line prefix are the
+	   ones of "%4u %7u " */
+{
+    const unsigned  iBlanks1 = p_iBlanks & 0xF,
+	iBlanks2 = (p_iBlanks >> 5) & 0x7F;
+
+    return ((((p_iBlanks | p_iDigits) & 0x1FFF) == 0x1FFF) &&
+	    ((p_iBlanks & 0x1010) == 0x1010) &&
+	    ((p_iDigits & 0x808) == 0x808) &&
+	    /* Leading blanks only */
+	    !(iBlanks1 & (iBlanks1 + 1)) && !(iBlanks2 & (iBlanks2 + 1)));
+}				/* FixedWidth() */
+
+
+static inline int MayMatch (const char *p_pcLine,
+			    const struct prefix_t *p_poPrefix)
+	/* Tell whether the line at p_pcLine has to be parsed */
+{
+    const __m128i   v = _mm_loadu_si128 ((const __m128i *) p_pcLine);
+    unsigned        iEqual, iBlanks, iDigits;
+
+    iEqual = _mm_movemask_epi8 (_mm_cmpeq_epi8 (v,
+						_mm_loadu_si128 ((const
+								  __m128i *)
+								 p_poPrefix->
+								 acPrefix)));
+    if ((iEqual & 0x1FFF) == 0x1FFF)
+	return (1);
+    iBlanks = _mm_movemask_epi8 (_mm_cmpeq_epi8 (v, _mm_set1_epi8 (' ')));
+    iDigits = _mm_movemask_epi8 (_mm_and_si128
+				 (_mm_cmpgt_epi8 (v, _mm_set1_epi8 ('0' - 1)),
+				  _mm_cmplt_epi8 (v, _mm_set1_epi8 ('9' + 1))));
+    return (!FixedWidth (iBlanks, iDigits));
+}				/* MayMatch() */
+
+
+static const char *ScanLinesSSE2 (const char *p_pc, const char *p_pcEnd,
+				  const struct prefix_t *p_poPrefix)
+	/* Return the first line, starting from p_pc, that has to be
+	   parsed, p_pcEnd if none */
+{
+    const __m128i   vNewLine = _mm_set1_epi8 ('\n');
+    const char     *pc, *pcLine;
+    unsigned        m;
+
+    if (MayMatch (p_pc, p_poPrefix))
+	return (p_pc);
+    for (pc = p_pc; pc < p_pcEnd; pc += 16) {
+	m = _mm_movemask_epi8 (_mm_cmpeq_epi8
+			       (_mm_loadu_si128 ((const __m128i *) pc),
+				vNewLine));
+	for (; m; m &= m - 1) {
+	    pcLine = pc + __builtin_ctz (m) + 1;
+	    if (pcLine >= p_pcEnd)
+		return (p_pcEnd);
+	    if (MayMatch (pcLine, p_poPrefix))
+		return (pcLine);
+	}
+    }
+    return (p_pcEnd);
+}				/* ScanLinesSSE2() */
+#endif
+
+
+#if defined(SCAN_AVX2)
+__attribute__ ((target ("avx2")))
+static const char *ScanLinesAVX2 (const char *p_pc, const char *p_pcEnd,
+				  const struct prefix_t *p_poPrefix)
+	/* Same as ScanLinesSSE2(), 32 bytes at a time */
+{
+    const __m256i   vNewLine = _mm256_set1_epi8 ('\n');
+    const char     *pc, *pcLine;
+    unsigned        m;
+
+    if (MayMatch (p_pc, p_poPrefix))
+	return (p_pc);
+    for (pc = p_pc; pc < p_pcEnd; pc += 32) {
+	m = _mm256_movemask_epi8 (_mm256_cmpeq_epi8
+				  (_mm256_loadu_si256 ((const __m256i *) pc),
+				   vNewLine));
+	for (; m; m &= m - 1) {
+	    pcLine = pc + __builtin_ctz (m) + 1;
+	    if (pcLine >= p_pcEnd)
+		return (p_pcEnd);
+	    if (MayMatch (pcLine, p_poPrefix))
+		return (pcLine);
 	}
-	fclose (pF);
-	gettimeofday (&oTimeStamp, 0);
-	p_poPerf->timestamp_ns =
-	    (uint64_t) 1000 *1000 * 1000 * oTimeStamp.tv_sec +
-	    1000 * oTimeStamp.tv_usec;
-	p_poPerf->rbytes = SECTOR_SIZE * rsect;
-	p_poPerf->wbytes = SECTOR_SIZE * wsect;
-	p_poPerf->qlen = running;
-	p_poPerf->rbusy_ns = (uint64_t) 1000 *1000 * ruse;
-	p_poPerf->wbusy_ns = (uint64_t) 1000 *1000 * wuse;
+    }
+    return (p_pcEnd);
+}				/* ScanLinesAVX2() */
+#endif
+
+
+static ScanLines_t SelectScanner (void)
+	/* Pick the widest scanner the processor supports */
+{
+#if defined(SCAN_AVX2)
+    __builtin_cpu_init ();
+    if (__builtin_cpu_supports ("avx2"))
+	return (ScanLinesAVX2);
+#endif
+#if defined(SCAN_SSE2)
+    return (ScanLinesSSE2);
+#else
+    return (ScanLinesScalar);
+#endif
+}				/* SelectScanner() */
+
+static ScanLines_t m_mScanLines = ScanLinesScalar;
+
+	/**************************************************************/
+
+	/* The order of the statistics lines only changes on hotplug. The
+	   byte offset of every device found is kept and checked first on
+	   the next lookup. On a miss the lines before it have usually
+	   grown (counters gaining digits), so the scan resumes from that
+	   offset before falling back to the whole file */
+
+typedef struct linepos_t {
+    dev_t           dev;
+    int             fValid;
+    size_t          iOffset;	/* Byte offset of the line */
+} linepos_t;
+
+static struct linepos_t *m_aoLinePos = 0;	/* Open-addressing table,
+						   grows, never shrinks */
+static size_t   m_iLinePosSize = 0, m_nLinePos = 0;
+
+
+static size_t LinePosHash (dev_t p_iDevice)
+{
+    const uint64_t  i = ((uint64_t) major(p_iDevice) << 32) |
+	minor(p_iDevice);
+    return ((size_t) ((i * 0x9E3779B97F4A7C15ULL) >> 32) &
+	    (m_iLinePosSize - 1));
+}				/* LinePosHash() */
+
+
+static struct linepos_t *LinePos (dev_t p_iDevice, int p_fCreate)
+	/* Return the cache entry of p_iDevice, creating it if p_fCreate
+	   is set - Only allocates when the number of devices grows */
+	/* Return NULL if not found or out of memory */
+{
+    struct linepos_t *poPos, *aoOld = m_aoLinePos;
+    size_t          i, iOldSize = m_iLinePosSize;
+
+    if (m_iLinePosSize)
+	for (i = LinePosHash (p_iDevice);; i = (i + 1) & (m_iLinePosSize - 1)) {
+	    poPos = m_aoLinePos + i;
+	    if (!poPos->fValid)
+		break;
+	    if (poPos->dev == p_iDevice)
+		return (poPos);
+	}
+    if (!p_fCreate)
 	return (0);
+    if (2 * (m_nLinePos + 1) > m_iLinePosSize) {
+	/* Keep the table at most half full */
+	poPos = calloc (iOldSize ? 2 * iOldSize : 64, sizeof (*poPos));
+	if (!poPos)
+	    return (0);
+	m_aoLinePos = poPos;
+	m_iLinePosSize = iOldSize ? 2 * iOldSize : 64;
+	m_nLinePos = 0;
+	for (i = 0; i < iOldSize; i++)
+	    if (aoOld[i].fValid)
+		*LinePos (aoOld[i].dev, 1) = aoOld[i];
+	free (aoOld);
     }
-  Error:
-    fclose (pF);
-    return (-1);
+    for (i = LinePosHash (p_iDevice); m_aoLinePos[i].fValid;
+	 i = (i + 1) & (m_iLinePosSize - 1));
+    poPos = m_aoLinePos + i;
+    poPos->dev = p_iDevice;
+    poPos->fValid = 1;
+    poPos->iOffset = 0;
+    m_nLinePos++;
+    return (poPos);
+}				/* LinePos() */
+
+
+static const char *ScanFrom (const char *p_pcLine, dev_t p_iDevice,
+			     const char **p_ppcFound)
+	/* Look for the line of p_iDevice from the line at p_pcLine to the
+	   end of the statistics */
+	/* Return a pointer past the device numbers, NULL if not found */
+{
+    const uint64_t  iMajorNo = major(p_iDevice),
+	iMinorNo = minor(p_iDevice);
+    const struct prefix_t *poPrefix = DevicePrefix (p_iDevice);
+    const ScanLines_t mScanLines =
+	(poPrefix->fFixed ? m_mScanLines : ScanLinesScalar);
+    const char     *pc, *pcEnd = m_pcBuffer + m_iLength;
+    uint64_t        major, minor;
+
+    for (; (p_pcLine = (*mScanLines) (p_pcLine, pcEnd, poPrefix)) < pcEnd;
+	 p_pcLine = NextLine (pc)) {
+	if (!(pc = ParseNumber (p_pcLine, &major))
+	    || !(pc = ParseNumber (pc, &minor)))
+	    break;
+	if ((major == iMajorNo) && (minor == iMinorNo)) {
+	    *p_ppcFound = p_pcLine;
+	    return (pc);
+	}
+    }
+    return (0);
+}				/* ScanFrom() */
+
+
+static const char *FindLine (dev_t p_iDevice)
+	/* Find the line of p_iDevice in the statistics */
+	/* Return a pointer past the device numbers, NULL if not found */
+{
+    struct linepos_t *poPos = LinePos (p_iDevice, 0);
+    const char     *pc = 0, *pcLine = 0;
+    uint64_t        major, minor;
+
+    if (poPos && (poPos->iOffset < m_iLength)) {
+	pcLine = m_pcBuffer + poPos->iOffset;
+	if (((pcLine == m_pcBuffer) || (pcLine[-1] == '\n')) &&
+	    (pc = ParseNumber (pcLine, &major)) &&
+	    (pc = ParseNumber (pc, &minor)) &&
+	    (major == major(p_iDevice)) && (minor == minor(p_iDevice)))
+	    return (pc);
+	if ((pcLine > m_pcBuffer) && (pcLine[-1] != '\n'))
+	    pcLine = NextLine (pcLine);
+	pc = ScanFrom (pcLine, p_iDevice, &pcLine);
+    }
+    if (!pc && (pcLine != m_pcBuffer))
+	pc = ScanFrom (m_pcBuffer, p_iDevice, &pcLine);
+    if (pc && (poPos || (poPos = LinePos (p_iDevice, 1))))
+	poPos->iOffset = pcLine - m_pcBuffer;
+    return (pc);
+}				/* FindLine() */
+
+
+static int DevGetPerfData1 (dev_t p_iDevice, struct devperf_t *p_poPerf)
+	/* Get disk performance statistics from STATISTICS_FILE_1 */
+{
+    const uint64_t  t0 = m_fCost ? Now_ns () : 0;
+    uint64_t        aiField[NFIELDS];
+    const char     *pc;
+    int             n, status = -1;
+
+    if ((pc = FindLine (p_iDevice))) {
+	pc = SkipWord (pc);	/* Skip device name */
+	n = ParseFields (pc, aiField);
+	if (n >= F_AVEQ) {
+	    StorePerf (aiField, 1, p_poPerf);
+	    status = 0;
+	}
+	else if (n >= 4) {
+	    /* Not a full-statistics line */
+	    StorePerf (aiField, 0, p_poPerf);
+	    status = 0;
+	}
+    }
+    if (m_fCost)
+	m_oCost.parse_ns += Now_ns () - t0;
+    return (status);
 }				/* DevGetPerfData1() */
 
 
 static int DevGetPerfData2 (dev_t p_iDevice, struct devperf_t *p_poPerf)
 	/* Get disk performance statistics from STATISTICS_FILE_2 */
 {
-    const int       iMajorNo = (p_iDevice >> 8) & 0xFF, /**/
+    const uint64_t  iMajorNo = (p_iDevice >> 8) & 0xFF, /**/
 	iMinorNo = p_iDevice & 0xFF;
-    struct timeval  oTimeStamp;
-    FILE           *pF;
-    unsigned int    major, minor, rsect, wsect, ruse, wuse, use;
-    int             running;
-    int             c, n;
-
-    pF = fopen (STATISTICS_FILE_2, "r");
-    if (!pF) {
-	perror (STATISTICS_FILE_2);
-	return (-1);
-    }
-    while ((c = fgetc (pF)) && (c != '\n'));	/* Skip the header line */
-    while ((n = fscanf (pF,
-			"%u %u %*u %*s %*u %*u %u %u %*u %*u %u %u %d %u %*u",
-			&major, &minor, &rsect, &ruse, &wsect,
-			&wuse, &running, &use)) == 8)
+    uint64_t        aiField[NFIELDS], major, minor, blocks, t0;
+    const char     *pc;
+    int             status = -1;
+
+    t0 = m_fCost ? Now_ns () : 0;
+    /* Skip the header line */
+    for (pc = NextLine (m_pcBuffer); *pc; pc = NextLine (pc)) {
+	if (*pc == '\n')
+	    continue;
+	if (!(pc = ParseNumber (pc, &major))
+	    || !(pc = ParseNumber (pc, &minor))
+	    || !(pc = ParseNumber (pc, &blocks)))
+	    break;
+	pc = SkipWord (pc);	/* Skip device name */
+	if (ParseFields (pc, aiField) < F_AVEQ)
+	    break;
 	if ((major == iMajorNo) && (minor == iMinorNo)) {
-	    fclose (pF);
-	    gettimeofday (&oTimeStamp, 0);
-	    p_poPerf->timestamp_ns =
-		(uint64_t) 1000 *1000 * 1000 * oTimeStamp.tv_sec +
-		1000 * oTimeStamp.tv_usec;
-	    p_poPerf->rbytes = SECTOR_SIZE * rsect;
-	    p_poPerf->wbytes = SECTOR_SIZE * wsect;
-	    p_poPerf->qlen = running;
-	    p_poPerf->rbusy_ns = (uint64_t) 1000 *1000 * ruse;
-	    p_poPerf->wbusy_ns = (uint64_t) 1000 *1000 * wuse;
-	    return (0);
+	    StorePerf (aiField, 1, p_poPerf);
+	    status = 0;
+	    break;
 	}
-    fclose (pF);
-    return (-1);
+    }
+    if (m_fCost)
+	m_oCost.parse_ns += Now_ns () - t0;
+    return (status);
 }				/* DevGetPerfData2() */
 
 	/**************************************************************/
 
-int DevPerfInit (void)
+static int InitStatFile (const char *p_pcStatFile)
+	/* Select the parser matching the format of p_pcStatFile */
+	/* Return 0 on success, NO_EXTENDED_STATS or -errno otherwise */
 {
-    FILE           *pF = 0;
+    FILE           *pF;
     char            acLine[256];
 
-    /* Kernel 2.6 ? */
-    m_pcStatFile = STATISTICS_FILE_1;
-    m_mGetPerfData = DevGetPerfData1;
+    m_pcStatFile = p_pcStatFile;
+    if (m_aoLinePos)
+	memset (m_aoLinePos, 0, m_iLinePosSize * sizeof (*m_aoLinePos));
+    m_nLinePos = 0;
     pF = fopen (m_pcStatFile, "r");
-    m_iInitStatus = 0;
-    if (pF)
-	goto End;
+    if (!pF)
+	return (-errno);
+    if ((fgets (acLine, sizeof (acLine), pF)) && (strstr (acLine, "major"))) {
+	/* Kernel 2.4 - /proc/partitions format, starting with a header */
+	m_mGetPerfData = DevGetPerfData2;
+	m_iInitStatus = (strstr (acLine, "rsect") ? 0 : NO_EXTENDED_STATS);
+    }
+    else {
+	/* Kernel 2.6 - /proc/diskstats format */
+	m_mGetPerfData = DevGetPerfData1;
+	m_mScanLines = SelectScanner ();
+	m_iInitStatus = 0;
+    }
+    fclose (pF);
+    if (m_oStatRead.iFd != -1)
+	close (m_oStatRead.iFd);
+    m_oStatRead.fReady = 0;
+    m_oStatRead.iFd = open (m_pcStatFile, O_RDONLY | O_CLOEXEC);
+    if (m_oStatRead.iFd == -1)
+	return (-errno);
+    if (!m_pcBuffer && GrowBuffer ())
+	return (-ENOMEM);
+    return (m_iInitStatus);
+}				/* InitStatFile() */
 
-    /* Kernel 2.4 */
-    m_pcStatFile = STATISTICS_FILE_2;
-    m_mGetPerfData = DevGetPerfData2;
-    pF = fopen (m_pcStatFile, "r");
-    if (pF)
-	m_iInitStatus = (((fgets (acLine, sizeof (acLine), pF))
-			  && (strstr (acLine, "rsect"))) ? 0 :
-			 NO_EXTENDED_STATS);
-    else
-	m_iInitStatus = -errno;
-
-  End:
-    if (pF)
-	fclose (pF);
+
+int DevPerfInit (void)
+{
+    /* Kernel 2.6 ? */
+    m_iInitStatus = InitStatFile (STATISTICS_FILE_1);
+    if (m_iInitStatus < 0)
+	/* Kernel 2.4 */
+	m_iInitStatus = InitStatFile (STATISTICS_FILE_2);
     return (m_iInitStatus);
 }				/* DevPerfInit() */
 
 
+int DevPerfInitFile (const char *p_pcStatFile)
+{
+    memset (m_acStatFile, 0, sizeof (m_acStatFile));
+    strncpy (m_acStatFile, p_pcStatFile, sizeof (m_acStatFile) - 1);
+    m_iInitStatus = InitStatFile (m_acStatFile);
+    return (m_iInitStatus);
+}				/* DevPerfInitFile() */
+
+
 int DevCheckStatAvailability (char const **p_ppcStatFile)
 {
     if (p_ppcStatFile)
@@ -201,10 +715,36 @@ int DevCheckStatAvailability (char const **p_ppcStatFile)
 int DevGetPerfData (const void *p_pvDevice, struct devperf_t *p_poPerf)
 {
     const dev_t     p_iDevice = *((dev_t *) p_pvDevice);
-    return ((m_mGetPerfData && !m_iInitStatus) ?
-	    (*m_mGetPerfData) (p_iDevice, p_poPerf) : -1);
+    memset (&m_oCost, 0, sizeof (m_oCost));
+    if (!m_mGetPerfData || m_iInitStatus || ReadStatFile ())
+	return (-1);
+    return ((*m_mGetPerfData) (p_iDevice, p_poPerf));
 }				/* DevGetPerfData() */
 
+
+struct kread_t *DevPerfKRead (void)
+{
+    return (m_oStatRead.pcBuffer ? &m_oStatRead : 0);
+}				/* DevPerfKRead() */
+
+
+int DevGetPerfDataN (int p_n, const void *const *p_ppvDevice,
+		     struct devperf_t *p_aoPerf, int *p_aiStatus)
+{
+    int             i, fRead, status = 0;
+
+    memset (&m_oCost, 0, sizeof (m_oCost));
+    /* The statistics are read once for all the devices */
+    fRead = m_mGetPerfData && !m_iInitStatus && !ReadStatFile ();
+    for (i = 0; i < p_n; i++) {
+	p_aiStatus[i] = !fRead ? -1 :
+	    (*m_mGetPerfData) (*((dev_t *) p_ppvDevice[i]), p_aoPerf + i);
+	if (p_aiStatus[i])
+	    status = -1;
+    }
+    return (status);
+}				/* DevGetPerfDataN() */
+
 	/**************************************************************/
 
 #if 0				/* Standalone test purpose */
@@ -261,7 +801,6 @@ int DevCheckStatAvailability(char const **strptr)
 
 int DevGetPerfData (const void *p_pvDevice, struct devperf_t *perf)
 {
-	struct timeval tv;
 	struct timespec ts;
 	static struct devinfo dinfo;
 	static struct statinfo stats = {.dinfo = &dinfo};
@@ -291,14 +830,14 @@ int DevGetPerfData (const void *p_pvDevice, struct devperf_t *perf)
 	if(check_dev != NULL && found) {
 		perf->wbytes = dev.bytes[DEVSTAT_WRITE];
 		perf->rbytes = dev.bytes[DEVSTAT_READ];
-		gettimeofday (&tv, 0);
-		perf->timestamp_ns = (uint64_t)1000ull * 1000ull * 1000ull *
-			tv.tv_sec + 1000ull * tv.tv_usec;
+		perf->timestamp_ns = Timestamp_ns ();
 		perf->qlen = dev.start_count - dev.end_count;
 		// I'm not sure about rbusy and wbusy calculation
 		bintime2timespec(&dev.busy_time, &ts);
 		perf->rbusy_ns = (uint64_t) ts.tv_nsec;
 		perf->wbusy_ns = perf->rbusy_ns;
+		perf->rios = dev.operations[DEVSTAT_READ];
+		perf->wios = dev.operations[DEVSTAT_WRITE];
 	}
 
 	return (0);
@@ -339,7 +878,6 @@ int DevCheckStatAvailability(char const **strptr)
 int DevGetPerfData (const void *p_pvDevice, struct devperf_t *perf)
 {
 	const char     *device = (const char *) p_pvDevice;
-	struct timeval tv;
 	size_t size, i, ndrives;
 	struct disk_sysctl *drives, drive;
 	int mib[3];
@@ -350,7 +888,9 @@ int DevGetPerfData (const void *p_pvDevice, struct devperf_t *perf)
 	if (sysctl(mib, 3, NULL, &size, NULL, 0) == -1)
 		return(-1);
 	ndrives = size / sizeof(struct disk_sysctl);
-	drives = malloc(size);
+	drives = SysctlBuffer(size);
+	if (drives == NULL)
+		return(-1);
 	if (sysctl(mib, 3, drives, &size, NULL, 0) == -1)
 		return(-1);
 
@@ -361,21 +901,20 @@ int DevGetPerfData (const void *p_pvDevice, struct devperf_t *perf)
 		}
 	}
 
-	free(drives);
-
 	if (i == ndrives)
 		return(-1);
 
-	gettimeofday (&tv, 0);
-	perf->timestamp_ns = (uint64_t)1000ull * 1000ull * 1000ull *
-		tv.tv_sec + 1000ull * tv.tv_usec;
+	perf->timestamp_ns = Timestamp_ns ();
 #if defined(__NetBSD_Version__) && (__NetBSD_Version__ < 106110000)
   /* NetBSD < 1.6K does not have separate read/write statistics. */
 	perf->rbytes = drive.dk_bytes;
 	perf->wbytes = drive.dk_bytes;
+	perf->rios = perf->wios = drive.dk_xfer;
 #else
 	perf->rbytes = drive.dk_rbytes;
 	perf->wbytes = drive.dk_wbytes;
+	perf->rios = drive.dk_rxfer;
+	perf->wios = drive.dk_wxfer;
 #endif
 
   /*
@@ -420,7 +959,6 @@ int DevGetPerfData (const void *p_pvDevice, struct devperf_t *perf)
 	size_t len;
 	char *devname = (char *)p_pvDevice;
 	struct diskstats *ds;
-	struct timeval tv;
 
 	mib[0] = CTL_HW;
 	mib[1] = HW_DISKCOUNT;
@@ -433,31 +971,21 @@ int DevGetPerfData (const void *p_pvDevice, struct devperf_t *perf)
 	mib[1] = HW_DISKSTATS;
 	len = diskn * sizeof(struct diskstats);
 
-	ds = malloc(len);
+	ds = SysctlBuffer(len);
 	if (ds == NULL)
 		return (-1);
 
-	if (sysctl(mib, 2, ds, &len, NULL, 0) < 0) {
-		free(ds);
+	if (sysctl(mib, 2, ds, &len, NULL, 0) < 0)
 		return (-1);
-	}
 
 	for (x = 0; x < diskn; x++)
 		if (!strcmp(ds[x].ds_name, devname))
 			break;
 
-	if (x == diskn) {
-		free(ds);
-		return (-1);
-	}
-
-	if (gettimeofday(&tv, NULL)) {
-		free(ds);
+	if (x == diskn)
 		return (-1);
-	}
 
-	perf->timestamp_ns = (uint64_t)1000ull * 1000ull * 1000ull * tv.tv_sec
-	    + 1000ull * tv.tv_usec; 
+	perf->timestamp_ns = Timestamp_ns ();
         perf->rbusy_ns = ((uint64_t)1000ull * 1000ull * 1000ull *
 	    ds[x].ds_time.tv_sec + 1000ull * ds[x].ds_time.tv_usec) / 2ull;
 
@@ -465,8 +993,8 @@ int DevGetPerfData (const void *p_pvDevice, struct devperf_t *perf)
 	perf->rbytes = ds[x].ds_rbytes;
 	perf->wbytes = ds[x].ds_wbytes;
 	perf->qlen = ds[x].ds_rxfer + ds[x].ds_wxfer;
-
-	free(ds);
+	perf->rios = ds[x].ds_rxfer;
+	perf->wios = ds[x].ds_wxfer;
 
 	return (0);
 }
@@ -520,9 +1048,11 @@ int DevGetPerfData (const void *p_pvDevice, struct devperf_t *perf)
 		return (-1);
 	}
 	kiot = KSTAT_IO_PTR(ksp);
-	perf->timestamp_ns = (uint64_t)ksp->ks_snaptime;
+	perf->timestamp_ns = Timestamp_ns ();
 	perf->rbytes = (uint64_t)kiot->nread;
 	perf->wbytes = (uint64_t)kiot->nwritten;
+	perf->rios = (uint64_t)kiot->reads;
+	perf->wios = (uint64_t)kiot->writes;
 	/*
 	 * Solaris keeps separate wait and run queues, but they aren't
 	 * separated by read and write. So allocate half to each.
@@ -542,3 +1072,40 @@ int DevGetPerfData (const void *p_pvDevice, struct devperf_t *perf)
 	/**************************************************************/
 #error "Your platform is not yet supported"
 #endif
+
+	/**************************************************************/
+
+#if !defined(__linux__)
+struct kread_t *DevPerfKRead (void)
+{
+    return (0);
+}				/* DevPerfKRead() */
+
+
+int DevGetPerfDataN (int p_n, const void *const *p_ppvDevice,
+		     struct devperf_t *p_aoPerf, int *p_aiStatus)
+{
+    uint32_t        iSyscalls = 0;
+    int             i, status = 0;
+
+    for (i = 0; i < p_n; i++) {
+	p_aiStatus[i] = DevGetPerfData (p_ppvDevice[i], p_aoPerf + i);
+	if (p_aiStatus[i])
+	    status = -1;
+	iSyscalls += m_oCost.syscalls;
+    }
+    m_oCost.syscalls = iSyscalls;
+    return (status);
+}				/* DevGetPerfDataN() */
+#endif
+
+void DevPerfSetCostAccounting (int p_fEnable)
+{
+    m_fCost = p_fEnable;
+}				/* DevPerfSetCostAccounting() */
+
+
+void DevGetPerfCost (struct devperf_cost_t *p_poCost)
+{
+    *p_poCost = m_oCost;
+}				/* DevGetPerfCost() */
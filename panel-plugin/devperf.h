@@ -24,7 +24,15 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <inttypes.h>
+#include <time.h>
 
+#if defined(CLOCK_BOOTTIME)
+#define DEVPERF_CLOCK	CLOCK_BOOTTIME
+/* Clock of the samples: counts the time asleep, so that a suspend shows
+   as a gap between samples */
+#else
+#define DEVPERF_CLOCK	CLOCK_MONOTONIC
+#endif
 
 enum {
     NO_ERROR,
@@ -32,15 +40,26 @@ enum {
 };
 
 
+struct kread_t;
+
 typedef struct devperf_t {
-    uint64_t        timestamp_ns;
+    uint64_t        timestamp_ns;	/* DEVPERF_CLOCK time - Not a wall
+					   clock */
     uint64_t        rbytes;	/* Number of bytes read from the device */
     uint64_t        wbytes;	/* Number of bytes written to the device */
     uint64_t        rbusy_ns;	/* Device read busy time */
     uint64_t        wbusy_ns;	/* Device write busy time */
+    uint64_t        rios;	/* Number of reads completed */
+    uint64_t        wios;	/* Number of writes completed */
     int32_t         qlen;	/* Current queue length */
 } devperf_t;
 
+typedef struct devperf_cost_t {
+    uint64_t        read_ns;	/* Time spent reading the statistics */
+    uint64_t        parse_ns;	/* Time spent parsing the statistics */
+    uint32_t        syscalls;	/* Number of system calls issued */
+} devperf_cost_t;
+
 
 #ifdef __cplusplus
 extern          "C" {
@@ -50,6 +69,13 @@ extern          "C" {
     /* Make required initialisations */
     /* Return 0 on success */
 
+#if defined(__linux__)
+    int             DevPerfInitFile (const char *StatisticsFile);
+    /* Same as DevPerfInit(), reading the statistics from an alternate
+       file in /proc/diskstats or /proc/partitions format */
+    /* Return 0 on success */
+#endif
+
     int             DevCheckStatAvailability (char const **StatisticsFile);
     /* Check the availability of required kernel statistics */
     /* Get the statistics file name */
@@ -60,6 +86,26 @@ extern          "C" {
     /* Get disk performance data stored by the kernel */
     /* Return 0 on success, -1 otherwise */
 
+    int             DevGetPerfDataN (int n, const void *const *devids,
+				     struct devperf_t *perf, int *status);
+    /* Same as DevGetPerfData() for n devices, the kernel statistics
+       being read only once (Linux) - status[i] receives the result of
+       devids[i] */
+    /* Return 0 if all the devices succeeded, -1 otherwise */
+
+    struct kread_t *DevPerfKRead (void);
+    /* Read of the statistics file, to be registered into a batch (see
+       kread.h): the next DevGetPerfData() or DevGetPerfDataN() call uses
+       what the batch read instead of reading the file itself */
+    /* Return NULL if the statistics do not come from a file */
+
+    void            DevPerfSetCostAccounting (int enable);
+    /* Turn on/off the timing of the collection (off by default) */
+
+    void            DevGetPerfCost (struct devperf_cost_t *cost);
+    /* Get the cost of the last DevGetPerfData() call - Times are only
+       accounted when enabled through DevPerfSetCostAccounting() */
+
 #ifdef __cplusplus
 }				/* extern "C" */
 #endif
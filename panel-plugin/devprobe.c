@@ -0,0 +1,138 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+	/* Device capability probe, used to derive per-device defaults */
+
+#include "devprobe.h"
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+	/* Full-scale I/O rates, MiB/s */
+#define MAX_XFER_ROTATIONAL	200
+#define MAX_XFER_SSD		550
+#define MAX_XFER_NVME		3000
+#define MAX_XFER_DEFAULT	40	/* Unknown device: historical value */
+
+
+#if defined(__linux__)
+	/**************************************************************/
+	/**************************	Linux	***********************/
+	/**************************************************************/
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#ifdef HAVE_SYS_SYSMACROS_H
+#include <sys/sysmacros.h>
+#endif
+
+
+static int ReadAttribute (int p_iDirFd, const char *p_pcName,
+			  char *p_pcBuffer, size_t p_iSize)
+	/* Read a sysfs attribute, trailing blanks removed */
+{
+    ssize_t         n;
+    int             fd;
+
+    *p_pcBuffer = 0;
+    if ((fd = openat (p_iDirFd, p_pcName, O_RDONLY | O_CLOEXEC)) == -1)
+	return (-1);
+    n = read (fd, p_pcBuffer, p_iSize - 1);
+    close (fd);
+    if (n < 0)
+	return (-1);
+    while ((n > 0) && ((unsigned char) p_pcBuffer[n - 1] <= ' '))
+	n--;
+    p_pcBuffer[n] = 0;
+    return (n);
+}				/* ReadAttribute() */
+
+
+static int ReadInt (int p_iDirFd, const char *p_pcName)
+{
+    char            acBuffer[32];
+
+    if (ReadAttribute (p_iDirFd, p_pcName, acBuffer, sizeof (acBuffer)) <= 0)
+	return (-1);
+    return (atoi (acBuffer));
+}				/* ReadInt() */
+
+
+int DevProbe (dev_t p_iDev, struct devprobe_t *p_poProbe)
+{
+    char            acPath[64], acLink[256];
+    ssize_t         n;
+    int             fd;
+
+    memset (p_poProbe, 0, sizeof (*p_poProbe));
+    snprintf (acPath, sizeof (acPath), "/sys/dev/block/%u:%u",
+	      major (p_iDev), minor (p_iDev));
+    if ((fd = open (acPath, O_RDONLY | O_DIRECTORY | O_CLOEXEC)) == -1)
+	return (-1);
+    if (faccessat (fd, "partition", F_OK, 0) == 0) {
+	/* Queue attributes belong to the whole disk */
+	close (fd);
+	strncat (acPath, "/..", sizeof (acPath) - strlen (acPath) - 1);
+	if ((fd = open (acPath, O_RDONLY | O_DIRECTORY | O_CLOEXEC)) == -1)
+	    return (-1);
+    }
+    p_poProbe->dev = p_iDev;
+    p_poProbe->fRotational = (ReadInt (fd, "queue/rotational") == 1);
+    p_poProbe->iMaxHwSectors_kB = ReadInt (fd, "queue/max_hw_sectors_kb");
+    p_poProbe->iNrRequests = ReadInt (fd, "queue/nr_requests");
+    p_poProbe->iLogicalBlockSize = ReadInt (fd, "queue/logical_block_size");
+    ReadAttribute (fd, "device/model", p_poProbe->acModel,
+		   sizeof (p_poProbe->acModel));
+    /* "device" links to .../nvme/nvme0 for NVMe namespaces */
+    n = readlinkat (fd, "device", acLink, sizeof (acLink) - 1);
+    if (n > 0) {
+	acLink[n] = 0;
+	p_poProbe->fNVMe = (strstr (acLink, "/nvme") != 0);
+    }
+    close (fd);
+    return (0);
+}				/* DevProbe() */
+
+#else
+	/**************************************************************/
+	/********************	Unsupported platform	***************/
+	/**************************************************************/
+
+int DevProbe (dev_t p_iDev, struct devprobe_t *p_poProbe)
+{
+    memset (p_poProbe, 0, sizeof (*p_poProbe));
+    return (-1);
+}				/* DevProbe() */
+
+#endif
+
+
+int DevProbeMaxXfer (const struct devprobe_t *p_poProbe)
+{
+    if (!p_poProbe->dev)
+	return (MAX_XFER_DEFAULT);
+    if (p_poProbe->fRotational)
+	return (MAX_XFER_ROTATIONAL);
+    if (p_poProbe->fNVMe)
+	return (MAX_XFER_NVME);
+    return (MAX_XFER_SSD);
+}				/* DevProbeMaxXfer() */
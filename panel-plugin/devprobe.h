@@ -0,0 +1,55 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _devprobe_h
+#define _devprobe_h
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <sys/types.h>
+
+
+typedef struct devprobe_t {
+    /* Device capabilities, as reported by the block layer */
+    dev_t           dev;	/* Device probed, 0 if none */
+    int             fRotational;
+    int             iMaxHwSectors_kB;	/* Largest request */
+    int             iNrRequests;	/* Request queue depth */
+    int             iLogicalBlockSize;	/* Bytes */
+    int             fNVMe;
+    char            acModel[64];
+} devprobe_t;
+
+
+#ifdef __cplusplus
+extern          "C" {
+#endif
+
+    int             DevProbe (dev_t dev, struct devprobe_t *probe);
+    /* Probe the capabilities of device dev (of its whole disk, for a
+       partition) */
+    /* Return 0 on success, -1 if they are not available */
+
+    int             DevProbeMaxXfer (const struct devprobe_t *probe);
+    /* Return a sensible full-scale I/O rate for the device, MiB/s */
+
+#ifdef __cplusplus
+}				/* extern "C" */
+#endif
+
+#endif				/* _devprobe_h */
@@ -0,0 +1,319 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+	/* Device state table: the counters and rates of every device the
+	   process monitors, in contiguous arrays indexed by slot, so that
+	   all of them are collected with a single read of the kernel
+	   statistics and processed by sweeping the arrays */
+
+#include "devstate.h"
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+
+static struct devstate_t m_oTable;
+
+	/* Scratch of DevStateUpdate() and DevStateMoved() */
+static int      m_aiCollectSlot[DEVSTATE_MAX];
+static const void *m_apvCollect[DEVSTATE_MAX];
+static struct devperf_t m_aoCollect[DEVSTATE_MAX];
+static int      m_aiCollectStatus[DEVSTATE_MAX];
+static uint8_t  m_afUpdated[DEVSTATE_MAX];
+
+
+static int SameDevice (int p_iSlot, const void *p_pvDevice)
+{
+#if !defined(__FreeBSD__) && !defined(__NetBSD__) && !defined(__OpenBSD__) && !defined(__sun__)
+    return (m_oTable.aiDevice[p_iSlot] == *((const dev_t *) p_pvDevice));
+#else
+    return (!strcmp (m_oTable.aacDevice[p_iSlot],
+		     (const char *) p_pvDevice));
+#endif
+}				/* SameDevice() */
+
+
+int DevStateAcquire (const void *p_pvDevice)
+{
+    struct devstate_t *poTable = &m_oTable;
+    int             i, iFree = -1;
+
+    for (i = 0; i < poTable->n; i++)
+	if (!poTable->aiRefs[i]) {
+	    if (iFree == -1)
+		iFree = i;
+	}
+	else if (SameDevice (i, p_pvDevice)) {
+	    poTable->aiRefs[i]++;
+	    return (i);
+	}
+    if (iFree == -1) {
+	if (poTable->n == DEVSTATE_MAX)
+	    return (-1);
+	iFree = poTable->n++;
+    }
+    poTable->aiRefs[iFree] = 1;
+#if !defined(__FreeBSD__) && !defined(__NetBSD__) && !defined(__OpenBSD__) && !defined(__sun__)
+    poTable->aiDevice[iFree] = *((const dev_t *) p_pvDevice);
+    poTable->apvDevice[iFree] = poTable->aiDevice + iFree;
+#else
+    memset (poTable->aacDevice[iFree], 0, sizeof (poTable->aacDevice[0]));
+    strncpy (poTable->aacDevice[iFree], (const char *) p_pvDevice,
+	     sizeof (poTable->aacDevice[0]) - 1);
+    poTable->apvDevice[iFree] = poTable->aacDevice[iFree];
+#endif
+    memset (poTable->aoPerf + iFree, 0, sizeof (poTable->aoPerf[0]));
+    poTable->aiStatus[iFree] = -1;
+    poTable->aiSamples[iFree] = 0;
+#if !SEPARATE_BUSY_TIMES
+    memset (poTable->aoBusySplit + iFree, 0, sizeof (poTable->aoBusySplit[0]));
+#endif
+    DevStateReset (iFree);
+    return (iFree);
+}				/* DevStateAcquire() */
+
+
+void DevStateRelease (int p_iSlot)
+{
+    struct devstate_t *poTable = &m_oTable;
+
+    if ((p_iSlot < 0) || (p_iSlot >= poTable->n)
+	|| !poTable->aiRefs[p_iSlot])
+	return;
+    poTable->aiRefs[p_iSlot]--;
+    while (poTable->n && !poTable->aiRefs[poTable->n - 1])
+	poTable->n--;
+}				/* DevStateRelease() */
+
+
+void DevStateReset (int p_iSlot)
+{
+    struct devstate_t *poTable = &m_oTable;
+
+    if ((p_iSlot < 0) || (p_iSlot >= poTable->n))
+	return;
+    poTable->aiPrevTimestamp_ns[p_iSlot] = 0;
+    poTable->aiInterval_ns[p_iSlot] = 0;
+    poTable->aiQlen[p_iSlot] = -1;
+    poTable->afChanged[p_iSlot] = 1;
+}				/* DevStateReset() */
+
+	/**************************************************************/
+
+static void ComputeRates (struct devstate_t *p_poTable, int p_i)
+	/* Rates of slot p_i between its previous counters and its last
+	   sample */
+{
+    const double    K = 1.0 * 1000 * 1000 * 1000 / 1024 / 1024;
+    /* bytes/ns --> MB/s */
+    const struct devperf_t *poPerf = p_poTable->aoPerf + p_i;
+    uint64_t        iInterval_ns, rbytes, wbytes, iRBusy_ns, iWBusy_ns,
+	rios, wios;
+    double          r;
+
+    iInterval_ns = poPerf->timestamp_ns - p_poTable->aiPrevTimestamp_ns[p_i];
+    rbytes = poPerf->rbytes - p_poTable->aiPrevRBytes[p_i];
+    wbytes = poPerf->wbytes - p_poTable->aiPrevWBytes[p_i];
+    iRBusy_ns = poPerf->rbusy_ns - p_poTable->aiPrevRBusy_ns[p_i];
+    iWBusy_ns = poPerf->wbusy_ns - p_poTable->aiPrevWBusy_ns[p_i];
+    rios = poPerf->rios - p_poTable->aiPrevRIos[p_i];
+    wios = poPerf->wios - p_poTable->aiPrevWIos[p_i];
+
+    p_poTable->aiInterval_ns[p_i] = iInterval_ns;
+    p_poTable->arRead[p_i] = K * rbytes / iInterval_ns;
+    p_poTable->arWrite[p_i] = K * wbytes / iInterval_ns;
+    p_poTable->arRIops[p_i] = 1e9 * rios / iInterval_ns;
+    p_poTable->arWIops[p_i] = 1e9 * wios / iInterval_ns;
+    if (poPerf->qlen < 0) {
+	p_poTable->arRBusy[p_i] = p_poTable->arWBusy[p_i] = 0;
+	p_poTable->arAwait_ms[p_i] = 0;
+    }
+    else {
+	r = 100.0 * iRBusy_ns / iInterval_ns;
+	p_poTable->arRBusy[p_i] = (r > 100) ? 100 : r;
+	r = 100.0 * iWBusy_ns / iInterval_ns;
+	p_poTable->arWBusy[p_i] = (r > 100) ? 100 : r;
+	p_poTable->arAwait_ms[p_i] = (rios + wios) ?
+	    (iRBusy_ns + iWBusy_ns) / 1e6 / (rios + wios) : 0;
+    }
+#if !SEPARATE_BUSY_TIMES
+    if (poPerf->qlen >= 0) {
+	struct perfstats_t oStats;
+
+	oStats.arIops[R_DATA] = p_poTable->arRIops[p_i];
+	oStats.arIops[W_DATA] = p_poTable->arWIops[p_i];
+	oStats.arIops[RW_DATA] = oStats.arIops[R_DATA] + oStats.arIops[W_DATA];
+	oStats.arPerf[R_DATA] = p_poTable->arRead[p_i];
+	oStats.arPerf[W_DATA] = p_poTable->arWrite[p_i];
+	oStats.arPerf[RW_DATA] = oStats.arPerf[R_DATA] + oStats.arPerf[W_DATA];
+	r = p_poTable->arRBusy[p_i] + p_poTable->arWBusy[p_i];
+	oStats.arBusy[RW_DATA] = (r > 100) ? 100 : r;
+	PerfStatsSplitBusy (p_poTable->aoBusySplit + p_i, &oStats);
+	p_poTable->arRBusy[p_i] = oStats.arBusy[R_DATA];
+	p_poTable->arWBusy[p_i] = oStats.arBusy[W_DATA];
+    }
+#endif
+    p_poTable->afChanged[p_i] = (rbytes || wbytes || iRBusy_ns || iWBusy_ns);
+    p_poTable->aiSamples[p_i]++;
+}				/* ComputeRates() */
+
+
+static int Continuity (const struct devstate_t *p_poTable, int p_i)
+	/* Check that the last sample of slot p_i follows its previous
+	   counters (see PerfStatsContinuity()) */
+{
+    struct devperf_t oPrev;
+
+    oPrev.timestamp_ns = p_poTable->aiPrevTimestamp_ns[p_i];
+    oPrev.rbytes = p_poTable->aiPrevRBytes[p_i];
+    oPrev.wbytes = p_poTable->aiPrevWBytes[p_i];
+    oPrev.rbusy_ns = p_poTable->aiPrevRBusy_ns[p_i];
+    oPrev.wbusy_ns = p_poTable->aiPrevWBusy_ns[p_i];
+    oPrev.rios = p_poTable->aiPrevRIos[p_i];
+    oPrev.wios = p_poTable->aiPrevWIos[p_i];
+    return (PerfStatsContinuity (&oPrev, p_poTable->aoPerf + p_i));
+}				/* Continuity() */
+
+
+int DevStateMoved (const int *p_aiSlot, int p_n)
+{
+    struct devstate_t *poTable = &m_oTable;
+    int             i, iSlot, n = 0;
+
+    /* Collect the available slots asked for */
+    for (i = 0; (i < p_n) && (n < DEVSTATE_MAX); i++) {
+	iSlot = p_aiSlot[i];
+	if ((iSlot < 0) || (iSlot >= poTable->n) || poTable->aiStatus[iSlot])
+	    continue;
+	if (!poTable->aiPrevTimestamp_ns[iSlot])
+	    return (1);
+	m_aiCollectSlot[n] = iSlot;
+	m_apvCollect[n] = poTable->apvDevice[iSlot];
+	memset (m_aoCollect + n, 0, sizeof (m_aoCollect[0]));
+	m_aoCollect[n++].qlen = -1;
+    }
+    if (!n)
+	return (0);
+    DevGetPerfDataN (n, m_apvCollect, m_aoCollect, m_aiCollectStatus);
+    for (i = 0; i < n; i++) {
+	iSlot = m_aiCollectSlot[i];
+	if (m_aiCollectStatus[i]
+	    || (m_aoCollect[i].rbytes != poTable->aiPrevRBytes[iSlot])
+	    || (m_aoCollect[i].wbytes != poTable->aiPrevWBytes[iSlot])
+	    || (m_aoCollect[i].rbusy_ns != poTable->aiPrevRBusy_ns[iSlot])
+	    || (m_aoCollect[i].wbusy_ns != poTable->aiPrevWBusy_ns[iSlot]))
+	    return (1);
+    }
+    return (0);
+}				/* DevStateMoved() */
+
+
+int DevStateUpdate (const int *p_aiSlot, int p_n)
+{
+    struct devstate_t *poTable = &m_oTable;
+    const struct devperf_t *poPerf;
+    int             i, iSlot, n = 0, status;
+
+    /* Collect the slots asked for */
+    for (i = 0; (i < p_n) && (n < DEVSTATE_MAX); i++)
+	if ((p_aiSlot[i] >= 0) && (p_aiSlot[i] < poTable->n)) {
+	    m_aiCollectSlot[n] = p_aiSlot[i];
+	    m_apvCollect[n] = poTable->apvDevice[p_aiSlot[i]];
+	    memset (m_aoCollect + n, 0, sizeof (m_aoCollect[0]));
+	    m_aoCollect[n++].qlen = -1;
+	}
+    status = DevGetPerfDataN (n, m_apvCollect, m_aoCollect,
+			      m_aiCollectStatus);
+    memset (m_afUpdated, 0, poTable->n);
+    for (i = 0; i < n; i++) {
+	iSlot = m_aiCollectSlot[i];
+	poTable->aoPerf[iSlot] = m_aoCollect[i];
+	poTable->aiStatus[iSlot] = m_aiCollectStatus[i];
+	m_afUpdated[iSlot] = !m_aiCollectStatus[i];
+	if (m_aiCollectStatus[i])	/* May come back as another device */
+	    DevStateReset (iSlot);
+    }
+
+    /* Then sweep the table */
+    for (i = 0; i < poTable->n; i++) {
+	if (!m_afUpdated[i])
+	    continue;
+	poPerf = poTable->aoPerf + i;
+	if (poTable->aiPrevTimestamp_ns[i]) {
+	    if (Continuity (poTable, i) != PERF_CONTINUOUS) {
+		/* Counters reset or gap: start over from this sample */
+		poTable->aiInterval_ns[i] = 0;
+		poTable->afChanged[i] = 1;
+	    }
+	    else if (poPerf->timestamp_ns < poTable->aiPrevTimestamp_ns[i]
+		     + DEVSTATE_MIN_INTERVAL_NS)
+		continue;	/* Keep the last rates */
+	    else
+		ComputeRates (poTable, i);
+	}
+	else
+	    poTable->afChanged[i] = 1;
+	poTable->aiQlen[i] = poPerf->qlen;
+	poTable->aiPrevTimestamp_ns[i] = poPerf->timestamp_ns;
+	poTable->aiPrevRBytes[i] = poPerf->rbytes;
+	poTable->aiPrevWBytes[i] = poPerf->wbytes;
+	poTable->aiPrevRBusy_ns[i] = poPerf->rbusy_ns;
+	poTable->aiPrevWBusy_ns[i] = poPerf->wbusy_ns;
+	poTable->aiPrevRIos[i] = poPerf->rios;
+	poTable->aiPrevWIos[i] = poPerf->wios;
+    }
+    return (status);
+}				/* DevStateUpdate() */
+
+
+const struct devstate_t *DevStateTable (void)
+{
+    return (&m_oTable);
+}				/* DevStateTable() */
+
+
+int DevStateStats (int p_iSlot, struct perfstats_t *p_poStats)
+{
+    const struct devstate_t *poTable = &m_oTable;
+    double          r;
+
+    if ((p_iSlot < 0) || (p_iSlot >= poTable->n)
+	|| poTable->aiStatus[p_iSlot])
+	return (-1);
+    if (!poTable->aiInterval_ns[p_iSlot])
+	return (1);
+    p_poStats->iInterval_ns = poTable->aiInterval_ns[p_iSlot];
+    p_poStats->qlen = poTable->aiQlen[p_iSlot];
+    p_poStats->fBusyValid = (p_poStats->qlen >= 0);
+    p_poStats->fBusyEstimated = p_poStats->fBusyValid && !SEPARATE_BUSY_TIMES;
+    p_poStats->arPerf[R_DATA] = poTable->arRead[p_iSlot];
+    p_poStats->arPerf[W_DATA] = poTable->arWrite[p_iSlot];
+    p_poStats->arPerf[RW_DATA] =
+	poTable->arRead[p_iSlot] + poTable->arWrite[p_iSlot];
+    p_poStats->arBusy[R_DATA] = poTable->arRBusy[p_iSlot];
+    p_poStats->arBusy[W_DATA] = poTable->arWBusy[p_iSlot];
+    r = poTable->arRBusy[p_iSlot] + poTable->arWBusy[p_iSlot];
+    p_poStats->arBusy[RW_DATA] = (r > 100) ? 100 : r;
+    p_poStats->arIops[R_DATA] = poTable->arRIops[p_iSlot];
+    p_poStats->arIops[W_DATA] = poTable->arWIops[p_iSlot];
+    p_poStats->arIops[RW_DATA] =
+	poTable->arRIops[p_iSlot] + poTable->arWIops[p_iSlot];
+    p_poStats->rAwait_ms = poTable->arAwait_ms[p_iSlot];
+    return (0);
+}				/* DevStateStats() */
@@ -0,0 +1,122 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _devstate_h
+#define _devstate_h
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <sys/types.h>
+#include <inttypes.h>
+
+#include "devperf.h"
+#include "perfstats.h"
+
+
+#define DEVSTATE_MAX	256	/* Slots */
+#define DEVSTATE_MIN_INTERVAL_NS	50000000
+/* Shorter intervals (a slot updated by several users in a row) keep
+   the previous rates */
+
+typedef struct devstate_t {
+    /* State of all the devices monitored by the process, as arrays
+       indexed by slot - Users only hold slot numbers */
+    int             n;		/* Slots in use are in [0, n[ */
+    int             aiRefs[DEVSTATE_MAX];	/* Users, 0 if free */
+#if !defined(__FreeBSD__) && !defined(__NetBSD__) && !defined(__OpenBSD__) && !defined(__sun__)
+    dev_t           aiDevice[DEVSTATE_MAX];
+#else
+    char            aacDevice[DEVSTATE_MAX][128];
+#endif
+    const void     *apvDevice[DEVSTATE_MAX];	/* DevGetPerfDataN()
+						   arguments */
+    struct devperf_t aoPerf[DEVSTATE_MAX];	/* Last sample */
+    int             aiStatus[DEVSTATE_MAX];	/* Of aoPerf: 0 or -1 */
+    /* Counters the rates were last computed from */
+    uint64_t        aiPrevTimestamp_ns[DEVSTATE_MAX];	/* 0 if none */
+    uint64_t        aiPrevRBytes[DEVSTATE_MAX];
+    uint64_t        aiPrevWBytes[DEVSTATE_MAX];
+    uint64_t        aiPrevRBusy_ns[DEVSTATE_MAX];
+    uint64_t        aiPrevWBusy_ns[DEVSTATE_MAX];
+    uint64_t        aiPrevRIos[DEVSTATE_MAX];
+    uint64_t        aiPrevWIos[DEVSTATE_MAX];
+    /* Rates of the last interval */
+    uint64_t        aiInterval_ns[DEVSTATE_MAX];	/* 0 if none yet */
+    double          arRead[DEVSTATE_MAX];	/* MiB/s */
+    double          arWrite[DEVSTATE_MAX];
+    double          arRBusy[DEVSTATE_MAX];	/* % */
+    double          arWBusy[DEVSTATE_MAX];
+    double          arRIops[DEVSTATE_MAX];
+    double          arWIops[DEVSTATE_MAX];
+    double          arAwait_ms[DEVSTATE_MAX];
+    int32_t         aiQlen[DEVSTATE_MAX];	/* -1 if unknown */
+    uint8_t         afChanged[DEVSTATE_MAX];	/* Counters moved */
+#if !SEPARATE_BUSY_TIMES
+    struct busysplit_t aoBusySplit[DEVSTATE_MAX];	/* arRBusy and
+							   arWBusy are
+							   estimates */
+#endif
+    uint32_t        aiSamples[DEVSTATE_MAX];
+    /* Intervals computed since the slot was taken, i.e. index of the
+       next history sample */
+} devstate_t;
+
+
+#ifdef __cplusplus
+extern          "C" {
+#endif
+
+    int             DevStateAcquire (const void *devid);
+    /* Get the slot of a device (see DevGetPerfData()), shared with the
+       other users of the same device */
+    /* Return the slot, -1 if the table is full */
+
+    void            DevStateRelease (int slot);
+    /* Give a slot back - Negative slots are ignored */
+
+    void            DevStateReset (int slot);
+    /* Forget the counters of a slot: the next update is a baseline */
+
+    int             DevStateMoved (const int *slots, int n);
+    /* Read the counters of the n slots and only compare them with the
+       ones their rates were last computed from - Nothing is updated -
+       Negative slots, and slots unavailable at the last update, are
+       ignored */
+    /* Return 1 if the counters of a slot moved (or it has no previous
+       counters, or cannot be read any more), 0 otherwise */
+
+    int             DevStateUpdate (const int *slots, int n);
+    /* Collect the n slots from a single read of the kernel statistics,
+       then compute their rates - Negative slots are ignored - A slot
+       whose counters went backwards, or was not updated for too long
+       or was unavailable, restarts from a baseline */
+    /* Return 0 if all the devices succeeded, -1 otherwise */
+
+    const struct devstate_t *DevStateTable (void);
+    /* Read access to the table */
+
+    int             DevStateStats (int slot, struct perfstats_t *stats);
+    /* Get the statistics of the last interval of a slot */
+    /* Return 0 on success, 1 if no interval is available yet, -1 if
+       the device statistics are unavailable */
+
+#ifdef __cplusplus
+}				/* extern "C" */
+#endif
+
+#endif				/* _devstate_h */
@@ -0,0 +1,487 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+	/* Microbenchmark of the kernel statistics parsers.
+	   Synthetic /proc/diskstats and /proc/partitions fixtures are
+	   generated for various device counts and line widths, then the
+	   collector is pointed at each of them through DevPerfInitFile()
+	   and the lookup of the last device is timed, along with the
+	   parsing part of it. The first lookup after DevPerfInitFile() is
+	   a full scan, the next ones find the device at its cached
+	   position.
+	   The statistics stage is then timed for PERFBATCH_MAX devices,
+	   one device at a time (PerfStatsUpdate() + PerfStatsFractions())
+	   and as a batch (PerfBatchUpdate()). */
+
+#include "devperf.h"
+#include "memcount.h"
+#include "metric.h"
+#include "perfstats.h"
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/types.h>
+/* for makedev() */
+#ifdef HAVE_SYS_SYSMACROS_H
+#include <sys/sysmacros.h>
+#endif
+
+#define PROGRAM_NAME	"diskperf-bench"
+
+
+#if defined(__linux__)
+
+typedef enum format_t {
+    DISKSTATS,			/* Kernel 2.6 - /proc/diskstats */
+    PARTITIONS			/* Kernel 2.4 - /proc/partitions */
+} format_t;
+
+typedef struct fixture_t {
+    enum format_t   eFormat;
+    int             iDevices;
+    int             iFields;	/* Statistics fields per line */
+} fixture_t;
+
+typedef struct result_t {
+    char            acName[32];
+    double          rLookup_ns;	/* Time per lookup */
+    double          rLine_ns;	/* Time per scanned line */
+    double          rParse_ns;	/* Parsing time per lookup */
+    double          rScan_ns;	/* Parsing time per line, without the
+				   position of the device cached */
+    double          rAllocations;	/* Heap allocations per lookup */
+} result_t;
+
+static const struct fixture_t m_aoFixture[] = {
+    {DISKSTATS, 10, 11}, {DISKSTATS, 10, 14},
+    {DISKSTATS, 10, 17}, {DISKSTATS, 10, 20},
+    {DISKSTATS, 1000, 11}, {DISKSTATS, 1000, 14},
+    {DISKSTATS, 1000, 17}, {DISKSTATS, 1000, 20},
+    {DISKSTATS, 10000, 11}, {DISKSTATS, 10000, 14},
+    {DISKSTATS, 10000, 17}, {DISKSTATS, 10000, 20},
+    {PARTITIONS, 10, 11}, {PARTITIONS, 1000, 11},
+    {PARTITIONS, 10000, 11}
+};
+
+#define NFIXTURES	(sizeof (m_aoFixture) / sizeof (*m_aoFixture))
+#define METRIC_EXPRESSION	"(d(rbusy)+d(wbusy))/dt*qlen"
+
+#define COLD_LOOKUPS	5	/* Lookups timed without the position of the
+				   device cached (best of) */
+
+	/**************************************************************/
+
+static void Usage (FILE *p_pF)
+{
+    fprintf (p_pF,
+	     "Usage: " PROGRAM_NAME " [options]\n"
+	     "  -d <dir>    Fixture directory (default: new one in $TMPDIR)\n"
+	     "  -k          Keep the generated fixtures\n"
+	     "  -m <ms>     Minimum measurement time per fixture"
+	     " (default 200)\n"
+	     "  -o <file>   Save the results as a baseline\n"
+	     "  -c <file>   Compare with a baseline, fail on regression\n"
+	     "  -r <pct>    Tolerated regression (default 25%%)\n"
+	     "  -t <ns>     Fail above <ns> per scanned line\n"
+	     "  -a <n>      Fail above <n> heap allocations per lookup\n"
+	     "  -h          Show this help\n");
+}				/* Usage() */
+
+	/**************************************************************/
+
+static void FixtureName (const struct fixture_t *p_poFixture, char *p_pcName,
+			 size_t p_iSize)
+{
+    if (p_poFixture->eFormat == PARTITIONS)
+	snprintf (p_pcName, p_iSize, "partitions-%d", p_poFixture->iDevices);
+    else
+	snprintf (p_pcName, p_iSize, "diskstats-%dx%d",
+		  p_poFixture->iDevices, p_poFixture->iFields);
+}				/* FixtureName() */
+
+
+static dev_t FixtureDevice (const struct fixture_t *p_poFixture, int p_i)
+	/* Device number of the p_i-th line, as expected by
+	   DevGetPerfData() */
+{
+    if (p_poFixture->eFormat == PARTITIONS)
+	/* 8-bit major and minor numbers of kernels 2.4 */
+	return (((3 + p_i / 256) << 8) | (p_i % 256));
+    return (makedev (8 + p_i / 1024, p_i % 1024));
+}				/* FixtureDevice() */
+
+
+static int WriteFixture (const struct fixture_t *p_poFixture,
+			 const char *p_pcPath)
+	/* Return 0 on success, -1 otherwise */
+{
+    FILE           *pF;
+    dev_t           iDev;
+    int             i, j;
+
+    pF = fopen (p_pcPath, "w");
+    if (!pF) {
+	perror (p_pcPath);
+	return (-1);
+    }
+    srand (p_poFixture->iDevices * 100 + p_poFixture->iFields);
+    if (p_poFixture->eFormat == PARTITIONS)
+	fprintf (pF, "major minor  #blocks  name     rio rmerge rsect ruse"
+		 " wio wmerge wsect wuse running use aveq\n\n");
+    for (i = 0; i < p_poFixture->iDevices; i++) {
+	iDev = FixtureDevice (p_poFixture, i);
+	if (p_poFixture->eFormat == PARTITIONS)
+	    fprintf (pF, "%4u %4u %9u dev%d", (unsigned) (iDev >> 8),
+		     (unsigned) (iDev & 0xFF), rand () % 100000000, i);
+	else
+	    fprintf (pF, "%4u %7u dm-%d", major (iDev), minor (iDev), i);
+	for (j = 0; j < p_poFixture->iFields; j++)
+	    fprintf (pF, " %u", rand () % ((j == 8) ? 64 : 1000000000));
+	fputc ('\n', pF);
+    }
+    return (fclose (pF) ? -1 : 0);
+}				/* WriteFixture() */
+
+	/**************************************************************/
+
+static uint64_t Now_ns (void)
+{
+    struct timespec oNow;
+
+    clock_gettime (CLOCK_MONOTONIC, &oNow);
+    return ((uint64_t) 1000 * 1000 * 1000 * oNow.tv_sec + oNow.tv_nsec);
+}				/* Now_ns() */
+
+
+static int RunFixture (const struct fixture_t *p_poFixture,
+		       const char *p_pcPath, int p_iMin_ms,
+		       struct result_t *p_poResult)
+	/* Return 0 on success, -1 otherwise */
+{
+    struct devperf_t oPerf;
+    struct devperf_cost_t oCost;
+    dev_t           iDev = FixtureDevice (p_poFixture,
+					  p_poFixture->iDevices - 1);
+    uint64_t        iStart_ns, iElapsed_ns, iParse_ns = 0;
+    int64_t         iAllocations;
+    long            n;
+
+    DevPerfSetCostAccounting (1);
+    p_poResult->rScan_ns = -1;
+    for (n = 0; n < COLD_LOOKUPS; n++) {
+	/* Re-initialising forgets the position of the device */
+	if (DevPerfInitFile (p_pcPath)) {
+	    fprintf (stderr, "%s: %s: Unusable fixture\n", PROGRAM_NAME,
+		     p_pcPath);
+	    return (-1);
+	}
+	/* Also warms up the page cache and the allocator */
+	if (DevGetPerfData (&iDev, &oPerf)) {
+	    fprintf (stderr, "%s: %s: Device not found\n", PROGRAM_NAME,
+		     p_pcPath);
+	    return (-1);
+	}
+	DevGetPerfCost (&oCost);
+	if ((p_poResult->rScan_ns < 0) ||
+	    (oCost.parse_ns < p_poResult->rScan_ns))
+	    p_poResult->rScan_ns = oCost.parse_ns;
+    }
+    p_poResult->rScan_ns /= p_poFixture->iDevices;
+
+    iAllocations = MemCountAllocations ();
+    iStart_ns = Now_ns ();
+    n = 0;
+    do {
+	DevGetPerfData (&iDev, &oPerf);
+	DevGetPerfCost (&oCost);
+	iParse_ns += oCost.parse_ns;
+	n++;
+	iElapsed_ns = Now_ns () - iStart_ns;
+    } while ((n < 3) || (iElapsed_ns < (uint64_t) p_iMin_ms * 1000 * 1000));
+
+    p_poResult->rLookup_ns = (double) iElapsed_ns / n;
+    p_poResult->rLine_ns = p_poResult->rLookup_ns / p_poFixture->iDevices;
+    p_poResult->rParse_ns = (double) iParse_ns / n;
+    p_poResult->rAllocations = (iAllocations < 0) ? -1 :
+	(double) (MemCountAllocations () - iAllocations) / n;
+    return (0);
+}				/* RunFixture() */
+
+static void NextSnapshot (struct devperf_t *p_aoPerf, int p_n)
+	/* Advance the counters of p_n devices by 500 ms of I/O */
+{
+    int             i;
+
+    for (i = 0; i < p_n; i++) {
+	p_aoPerf[i].timestamp_ns += 500 * 1000 * 1000;
+	p_aoPerf[i].rbytes += (uint64_t) (i % 97) << 16;
+	p_aoPerf[i].wbytes += (uint64_t) (i % 89) << 16;
+	p_aoPerf[i].rbusy_ns += (i % 83) * 1000 * 1000;
+	p_aoPerf[i].wbusy_ns += (i % 79) * 1000 * 1000;
+    }
+}				/* NextSnapshot() */
+
+
+static void RunRates (int p_iMin_ms, double *p_prSingle_ns,
+		      double *p_prBatch_ns, double *p_prMetric_ns)
+	/* Time the statistics stage per device, one device at a time and
+	   as a batch (the counters update is timed in both), then a
+	   derived metric */
+{
+    static struct devperf_t aoPerf[PERFBATCH_MAX],
+	aoPrevPerf[PERFBATCH_MAX];
+    static struct perfbatch_t oBatch;
+    static int      aiStatus[PERFBATCH_MAX];
+    struct perfstats_t oStats;
+    struct metric_t oMetric;
+    char            acError[64];
+    volatile double rMetric;
+    double          arFraction[NMONITORS];
+    uint64_t        iStart_ns, iElapsed_ns;
+    long            n;
+    int             i;
+
+    iStart_ns = Now_ns ();
+    n = 0;
+    do {
+	NextSnapshot (aoPerf, PERFBATCH_MAX);
+	for (i = 0; i < PERFBATCH_MAX; i++) {
+	    PerfStatsUpdate (aoPrevPerf + i, aoPerf + i, &oStats);
+	    PerfStatsFractions (&oStats, IO_TRANSFER, 40, arFraction);
+	}
+	n++;
+	iElapsed_ns = Now_ns () - iStart_ns;
+    } while ((n < 3) || (iElapsed_ns < (uint64_t) p_iMin_ms * 1000 * 1000));
+    *p_prSingle_ns = (double) iElapsed_ns / n / PERFBATCH_MAX;
+
+    PerfBatchInit (&oBatch, PERFBATCH_MAX);
+    iStart_ns = Now_ns ();
+    n = 0;
+    do {
+	NextSnapshot (aoPerf, PERFBATCH_MAX);
+	PerfBatchUpdate (&oBatch, aoPerf, aiStatus, IO_TRANSFER, 40);
+	n++;
+	iElapsed_ns = Now_ns () - iStart_ns;
+    } while ((n < 3) || (iElapsed_ns < (uint64_t) p_iMin_ms * 1000 * 1000));
+    *p_prBatch_ns = (double) iElapsed_ns / n / PERFBATCH_MAX;
+
+    MetricCompile (&oMetric, METRIC_EXPRESSION, acError, sizeof (acError));
+    iStart_ns = Now_ns ();
+    n = 0;
+    do {
+	memcpy (aoPrevPerf, aoPerf, sizeof (aoPrevPerf));
+	NextSnapshot (aoPerf, PERFBATCH_MAX);
+	for (i = 0; i < PERFBATCH_MAX; i++)
+	    rMetric = MetricEval (&oMetric, aoPrevPerf + i, aoPerf + i);
+	n++;
+	iElapsed_ns = Now_ns () - iStart_ns;
+    } while ((n < 3) || (iElapsed_ns < (uint64_t) p_iMin_ms * 1000 * 1000));
+    (void) rMetric;
+    *p_prMetric_ns = (double) iElapsed_ns / n / PERFBATCH_MAX;
+}				/* RunRates() */
+
+	/**************************************************************/
+
+static int SaveBaseline (const char *p_pcFile,
+			 const struct result_t *p_poResult, int p_n)
+	/* Return 0 on success, -1 otherwise */
+{
+    FILE           *pF;
+    int             i;
+
+    pF = fopen (p_pcFile, "w");
+    if (!pF) {
+	perror (p_pcFile);
+	return (-1);
+    }
+    for (i = 0; i < p_n; i++)
+	fprintf (pF, "%s %.1f %.2f\n", p_poResult[i].acName,
+		 p_poResult[i].rLookup_ns, p_poResult[i].rAllocations);
+    return (fclose (pF) ? -1 : 0);
+}				/* SaveBaseline() */
+
+
+static int CompareBaseline (const char *p_pcFile,
+			    const struct result_t *p_poResult, int p_n,
+			    double p_rTolerance)
+	/* Return the number of regressions, -1 on error */
+{
+    FILE           *pF;
+    char            acName[32];
+    double          rLookup_ns, rAllocations;
+    int             i, nRegressions = 0;
+
+    pF = fopen (p_pcFile, "r");
+    if (!pF) {
+	perror (p_pcFile);
+	return (-1);
+    }
+    while (fscanf (pF, "%31s %lf %lf", acName, &rLookup_ns,
+		   &rAllocations) == 3)
+	for (i = 0; i < p_n; i++) {
+	    if (strcmp (acName, p_poResult[i].acName))
+		continue;
+	    if (p_poResult[i].rLookup_ns >
+		rLookup_ns * (1 + p_rTolerance / 100)) {
+		printf ("REGRESSION %s: %.1f ns/lookup (baseline %.1f)\n",
+			acName, p_poResult[i].rLookup_ns, rLookup_ns);
+		nRegressions++;
+	    }
+	    if (p_poResult[i].rAllocations > rAllocations) {
+		printf ("REGRESSION %s: %.2f allocations/lookup"
+			" (baseline %.2f)\n", acName,
+			p_poResult[i].rAllocations, rAllocations);
+		nRegressions++;
+	    }
+	}
+    fclose (pF);
+    return (nRegressions);
+}				/* CompareBaseline() */
+
+	/**************************************************************/
+
+int main (int argc, char **argv)
+{
+    struct result_t aoResult[NFIXTURES];
+    char            acDir[256], acPath[1024];
+    const char     *pcDir = 0, *pcSave = 0, *pcCompare = 0, *pcTmp;
+    double          rTolerance = 25, rMaxLine_ns = 0, rMaxAllocations = -1;
+    double          rSingle_ns, rBatch_ns, rMetric_ns;
+    int             fKeep = 0, iMin_ms = 200, nFailures = 0, status, c;
+    size_t          i;
+
+    while ((c = getopt (argc, argv, "d:km:o:c:r:t:a:h")) != -1)
+	switch (c) {
+	    case 'd':
+		pcDir = optarg;
+		break;
+	    case 'k':
+		fKeep = 1;
+		break;
+	    case 'm':
+		iMin_ms = atoi (optarg);
+		break;
+	    case 'o':
+		pcSave = optarg;
+		break;
+	    case 'c':
+		pcCompare = optarg;
+		break;
+	    case 'r':
+		rTolerance = atof (optarg);
+		break;
+	    case 't':
+		rMaxLine_ns = atof (optarg);
+		break;
+	    case 'a':
+		rMaxAllocations = atof (optarg);
+		break;
+	    case 'h':
+		Usage (stdout);
+		return (0);
+	    default:
+		Usage (stderr);
+		return (2);
+	}
+
+    if (!pcDir) {
+	pcTmp = getenv ("TMPDIR");
+	snprintf (acDir, sizeof (acDir), "%s/diskperf-bench.XXXXXX",
+		  (pcTmp && *pcTmp) ? pcTmp : "/tmp");
+	if (!mkdtemp (acDir)) {
+	    perror (acDir);
+	    return (1);
+	}
+	pcDir = acDir;
+    }
+
+    printf ("%-22s %10s %10s %10s %10s %14s\n", "Fixture", "ns/lookup",
+	    "ns/line", "parse ns", "scan/line", "allocs/lookup");
+    for (i = 0; i < NFIXTURES; i++) {
+	FixtureName (m_aoFixture + i, aoResult[i].acName,
+		     sizeof (aoResult[i].acName));
+	if (snprintf (acPath, sizeof (acPath), "%s/%s", pcDir,
+		      aoResult[i].acName) >= (int) sizeof (acPath)) {
+	    fprintf (stderr, "%s: %s: Directory name too long\n",
+		     PROGRAM_NAME, pcDir);
+	    return (1);
+	}
+	status = WriteFixture (m_aoFixture + i, acPath);
+	if (!status)
+	    status = RunFixture (m_aoFixture + i, acPath, iMin_ms,
+				 aoResult + i);
+	if (!fKeep)
+	    unlink (acPath);
+	if (status)
+	    return (1);
+	printf ("%-22s %10.1f %10.1f %10.1f %10.1f %14.2f\n",
+		aoResult[i].acName, aoResult[i].rLookup_ns,
+		aoResult[i].rLine_ns, aoResult[i].rParse_ns,
+		aoResult[i].rScan_ns, aoResult[i].rAllocations);
+	if ((rMaxLine_ns > 0) && (aoResult[i].rLine_ns > rMaxLine_ns)) {
+	    printf ("THRESHOLD %s: %.1f ns/line\n", aoResult[i].acName,
+		    aoResult[i].rLine_ns);
+	    nFailures++;
+	}
+	if ((rMaxAllocations >= 0)
+	    && (aoResult[i].rAllocations > rMaxAllocations)) {
+	    printf ("THRESHOLD %s: %.2f allocations/lookup\n",
+		    aoResult[i].acName, aoResult[i].rAllocations);
+	    nFailures++;
+	}
+    }
+    if ((pcDir == acDir) && !fKeep)
+	rmdir (acDir);
+
+    RunRates (iMin_ms, &rSingle_ns, &rBatch_ns, &rMetric_ns);
+    printf ("\n%-22s %10s %10s\n", "Statistics", "ns/device",
+	    "devices");
+    printf ("%-22s %10.1f %10d\n", "per device", rSingle_ns,
+	    PERFBATCH_MAX);
+    printf ("%-22s %10.1f %10d\n", "batch", rBatch_ns, PERFBATCH_MAX);
+    printf ("%-22s %10.1f %10d\n", "metric", rMetric_ns, PERFBATCH_MAX);
+
+    if (pcSave && SaveBaseline (pcSave, aoResult, NFIXTURES))
+	return (1);
+    if (pcCompare) {
+	status = CompareBaseline (pcCompare, aoResult, NFIXTURES,
+				  rTolerance);
+	if (status < 0)
+	    return (1);
+	nFailures += status;
+    }
+    return (nFailures ? 1 : 0);
+}				/* main() */
+
+#else
+
+int main (void)
+{
+    fprintf (stderr, "%s: The statistics file parsers only exist on"
+	     " Linux\n", PROGRAM_NAME);
+    return (77);
+}				/* main() */
+
+#endif
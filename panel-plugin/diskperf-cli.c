@@ -0,0 +1,633 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+	/* Headless front-end of the diskperf statistics engine: prints
+	   iostat-like lines for one or more devices */
+
+#include "alert.h"
+#include "devperf.h"
+#include "kread.h"
+#include "perfstats.h"
+#include "exporter.h"
+#include "memcount.h"
+#include "metric.h"
+#include "mountdev.h"
+#include "samplering.h"
+#include "sleepwatch.h"
+#include "tickcost.h"
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#define PROGRAM_NAME	"diskperf-cli"
+#define MAX_DEVICES	64
+#define ALLOC_WARMUP_PERIODS	2	/* Not checked by -a */
+#if SEPARATE_BUSY_TIMES
+#define R_BUSY_TITLE	"r_busy%"
+#define W_BUSY_TITLE	"w_busy%"
+#else				/* Estimated (PerfStatsSplitBusy()) */
+#define R_BUSY_TITLE	"r_est%"
+#define W_BUSY_TITLE	"w_est%"
+#endif
+
+
+typedef struct device_t {
+    const char     *pcName;
+#if  !defined(__FreeBSD__) && !defined(__NetBSD__) && !defined(__OpenBSD__) && !defined(__sun__)
+    dev_t           st_rdev;
+#endif
+    struct devperf_t
+                    oPerf;
+    struct devperf_t
+                    oPrevPerf;
+    struct busysplit_t
+                    oBusySplit;	/* Busy times reported as a total */
+    struct alerts_t oAlerts;	/* Rules of -A, with their state for this
+				   device */
+} device_t;
+
+typedef struct recorder_t {
+    /* Writes the samples to the record file from its own thread, so
+       that a slow file system never delays the collection */
+    FILE           *pF;
+    const char     *const *apcName;
+    struct samplering_t
+                   *poRing;
+    struct samplering_reader_t
+                    oReader;
+    long            iPeriod_ms;
+    int             fStop;
+} recorder_t;
+
+	/**************************************************************/
+
+static void Usage (FILE *p_pF)
+{
+    fprintf (p_pF,
+	     "Usage: " PROGRAM_NAME " [options] device|mount-point...\n"
+	     "  -i <ms>     Update period in milliseconds (default 1000)\n"
+	     "  -c <count>  Number of reports, 0 for infinite (default 0)\n"
+	     "  -x <MiB/s>  Maximum I/O rate, used for the bar column"
+	     " (default 40)\n"
+	     "  -e <path>   Serve OpenMetrics text on Unix socket <path>\n"
+	     "  -v          Report the cost of each period (collection,"
+	     " parsing,\n"
+	     "              rendering, system calls)\n"
+	     "  -w <file>   Record the raw samples into <file>\n"
+	     "  -r <file>   Replay the samples recorded in <file> and print"
+	     " the\n"
+	     "              computed statistics (no device argument)\n"
+	     "  -a          Check that no period allocates heap memory once"
+	     " warmed up\n"
+	     "              (exit status 3 otherwise)\n"
+	     "  -u          Read the statistics through io_uring"
+	     " (falls back to pread)\n"
+	     "  -m <expr>   Add a column computing the derived metric <expr>"
+	     " (see\n"
+	     "              metric.h), e.g."
+	     " \"(d(rbytes)+d(wbytes))/(d(rios)+d(wios))\"\n"
+	     "  -A <rules>  Report the alert rules (see alert.h) that fire,"
+	     " e.g.\n"
+	     "              \"util > 95 for 60; await > 50\"\n"
+	     "  -h          Show this help\n");
+}				/* Usage() */
+
+	/**************************************************************/
+
+static void GetDevicesPerf (struct device_t *p_aoDevice, int p_n)
+	/* Collect the performance data of all the devices, reading the
+	   kernel statistics once */
+{
+    const void     *apvDevice[MAX_DEVICES];
+    struct devperf_t aoPerf[MAX_DEVICES];
+    int             aiStatus[MAX_DEVICES], i;
+
+    memset (aoPerf, 0, sizeof (aoPerf));
+    for (i = 0; i < p_n; i++) {
+	aoPerf[i].qlen = -1;
+#if defined(__FreeBSD__) || defined (__NetBSD__) || defined(__OpenBSD__) || defined(__sun__)
+	apvDevice[i] = p_aoDevice[i].pcName;
+#else
+	apvDevice[i] = &(p_aoDevice[i].st_rdev);
+#endif
+    }
+    DevGetPerfDataN (p_n, apvDevice, aoPerf, aiStatus);
+    for (i = 0; i < p_n; i++) {
+	p_aoDevice[i].oPerf = aoPerf[i];
+	if (aiStatus[i]) {
+	    fprintf (stderr, "%s: %s: Device statistics unavailable\n",
+		     PROGRAM_NAME, p_aoDevice[i].pcName);
+	    /* It may come back as another device */
+	    p_aoDevice[i].oPrevPerf.timestamp_ns = 0;
+	    AlertReset (&(p_aoDevice[i].oAlerts));
+	}
+    }
+}				/* GetDevicesPerf() */
+
+
+static void CheckAlerts (struct device_t *p_poDevice,
+			 const struct perfstats_t *p_poStats,
+			 const double *p_prMetric, FILE *p_pF,
+			 const char *p_pcPrefix)
+	/* Print a line per alert rule firing at the end of the interval */
+{
+    struct alerts_t *poAlerts = &(p_poDevice->oAlerts);
+    char            acText[128];
+    uint32_t        iFiring;
+    int             i;
+
+    if (!poAlerts->n)
+	return;
+    iFiring = AlertUpdate (poAlerts, p_poStats, p_prMetric,
+			   p_poDevice->oPerf.timestamp_ns);
+    for (i = 0; i < poAlerts->n; i++)
+	if (iFiring & (1u << i)) {
+	    AlertFormat (poAlerts, i, acText, sizeof (acText));
+	    fprintf (p_pF, "%s%s alert %s\n", p_pcPrefix,
+		     p_poDevice->pcName, acText);
+	}
+}				/* CheckAlerts() */
+
+
+static void PrintStats (const struct device_t *p_poDevice,
+			const struct perfstats_t *p_poStats,
+			int p_iMaxXferMBperSec,
+			const struct metric_t *p_poMetric, double p_rMetric)
+	/* p_rMetric is shown if p_poMetric is not empty */
+{
+    double          arFraction[NMONITORS];
+
+    PerfStatsFractions (p_poStats, IO_TRANSFER, p_iMaxXferMBperSec,
+			arFraction);
+    printf ("%-16s %9.2f %9.2f %9.2f", p_poDevice->pcName,
+	    p_poStats->arPerf[R_DATA], p_poStats->arPerf[W_DATA],
+	    p_poStats->arPerf[RW_DATA]);
+    if (p_poStats->fBusyValid)
+	printf (" %7.1f %7.1f %7.1f %5d",
+		p_poStats->arBusy[R_DATA], p_poStats->arBusy[W_DATA],
+		p_poStats->arBusy[RW_DATA], (int) p_poStats->qlen);
+    else
+	printf (" %7s %7s %7s %5s", "-", "-", "-", "-");
+    printf (" %5.1f", 100 * arFraction[RW_DATA]);
+    if (p_poMetric->n)
+	printf (" %11.6g", p_rMetric);
+    printf ("\n");
+}				/* PrintStats() */
+
+
+static void PrintCosts (const struct tickcost_t *p_poCost)
+{
+    struct tickcost_sample_t oAverage, oMaximum;
+    int             n;
+
+    n = TickCostSummary (p_poCost, &oAverage, &oMaximum);
+    printf ("# cost avg/max over %d periods (us): collect %.1f/%.1f"
+	    " parse %.1f/%.1f render %.1f/%.1f syscalls %u/%u\n", n,
+	    oAverage.collect_ns / 1e3, oMaximum.collect_ns / 1e3,
+	    oAverage.parse_ns / 1e3, oMaximum.parse_ns / 1e3,
+	    oAverage.render_ns / 1e3, oMaximum.render_ns / 1e3,
+	    oAverage.syscalls, oMaximum.syscalls);
+}				/* PrintCosts() */
+
+	/**************************************************************/
+
+	/* Recorded samples: one line per device and period
+	   <device> <timestamp_ns> <rbytes> <wbytes> <rbusy_ns> <wbusy_ns> <qlen>
+	   <rios> <wios>
+	   The I/O counts may be missing (older recordings). Lines starting
+	   with '#' are comments. */
+
+static void RecordSample (FILE *p_pF, const char *p_pcName,
+			  const struct devperf_t *p_poPerf)
+{
+    fprintf (p_pF, "%s %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64
+	     " %" PRIu64 " %d %" PRIu64 " %" PRIu64 "\n", p_pcName,
+	     p_poPerf->timestamp_ns, p_poPerf->rbytes, p_poPerf->wbytes,
+	     p_poPerf->rbusy_ns, p_poPerf->wbusy_ns, (int) p_poPerf->qlen,
+	     p_poPerf->rios, p_poPerf->wios);
+}				/* RecordSample() */
+
+
+static void *Recorder (void *p_pvRecorder)
+	/* Record file thread: drain the sample ring once per period, and
+	   once more when asked to stop */
+{
+    struct recorder_t *poRecorder = p_pvRecorder;
+    struct samplering_reader_t *poReader = &(poRecorder->oReader);
+    struct devperf_t oPerf;
+    struct timespec oPeriod;
+    uint64_t        iSkipped = 0;
+    uint32_t        iDevice, iFlags;
+    int             fStop;
+
+    oPeriod.tv_sec = poRecorder->iPeriod_ms / 1000;
+    oPeriod.tv_nsec = (poRecorder->iPeriod_ms % 1000) * 1000 * 1000;
+    do {
+	fStop = __atomic_load_n (&(poRecorder->fStop), __ATOMIC_ACQUIRE);
+	while (SampleRingRead (poRecorder->poRing, poReader, &iDevice,
+			       &iFlags, &oPerf)) {
+	    if (poReader->iSkipped != iSkipped) {
+		fprintf (poRecorder->pF, "# %" PRIu64 " samples lost\n",
+			 poReader->iSkipped - iSkipped);
+		iSkipped = poReader->iSkipped;
+	    }
+	    RecordSample (poRecorder->pF, poRecorder->apcName[iDevice],
+			  &oPerf);
+	}
+	fflush (poRecorder->pF);
+	if (!fStop)
+	    nanosleep (&oPeriod, 0);
+    } while (!fStop);
+    return (0);
+}				/* Recorder() */
+
+
+static int Replay (const char *p_pcFile, int p_iMaxXferMBperSec,
+		   const struct metric_t *p_poMetric,
+		   const struct alerts_t *p_poAlerts)
+	/* Feed the statistics engine with recorded samples and print
+	   everything it computes, in a stable format fit for diff(1) -
+	   Followed by the metric, if p_poMetric is not empty, and the
+	   alerts of p_poAlerts */
+	/* Return 0 on success, 1 otherwise */
+{
+    static char     aacName[MAX_DEVICES][128];
+    struct device_t aoDevice[MAX_DEVICES], *poDevice;
+    struct devperf_t oPerf;
+    struct perfstats_t oStats;
+    double          arIO[NMONITORS], arBusy[NMONITORS], rMetric = 0;
+    char            acLine[512], acName[128];
+    FILE           *pF;
+    int             nDevices = 0, iLine = 0, qlen, n, i, status;
+
+    pF = strcmp (p_pcFile, "-") ? fopen (p_pcFile, "r") : stdin;
+    if (!pF) {
+	perror (p_pcFile);
+	return (1);
+    }
+    memset (aoDevice, 0, sizeof (aoDevice));
+    printf ("# device interval_ns rMiB/s wMiB/s MiB/s r_busy%% w_busy%%"
+	    " busy%% io_bars(r w rw) busy_bars(r w rw)%s\n",
+	    p_poMetric->n ? " metric" : "");
+    while (fgets (acLine, sizeof (acLine), pF)) {
+	iLine++;
+	if ((*acLine == '#') || (*acLine == '\n'))
+	    continue;
+	memset (&oPerf, 0, sizeof (oPerf));
+	n = sscanf (acLine, "%127s %" SCNu64 " %" SCNu64 " %" SCNu64
+		    " %" SCNu64 " %" SCNu64 " %d %" SCNu64 " %" SCNu64, acName,
+		    &oPerf.timestamp_ns, &oPerf.rbytes, &oPerf.wbytes,
+		    &oPerf.rbusy_ns, &oPerf.wbusy_ns, &qlen, &oPerf.rios,
+		    &oPerf.wios);
+	if ((n != 7) && (n != 9)) {
+	    fprintf (stderr, "%s: %s:%d: Malformed sample\n", PROGRAM_NAME,
+		     p_pcFile, iLine);
+	    goto Error;
+	}
+	oPerf.qlen = qlen;
+	for (i = 0; i < nDevices; i++)
+	    if (!strcmp (aoDevice[i].pcName, acName))
+		break;
+	if (i == nDevices) {
+	    if (nDevices == MAX_DEVICES) {
+		fprintf (stderr, "%s: Too many devices\n", PROGRAM_NAME);
+		goto Error;
+	    }
+	    strcpy (aacName[nDevices], acName);
+	    aoDevice[nDevices].oAlerts = *p_poAlerts;
+	    aoDevice[nDevices++].pcName = aacName[i];
+	}
+	poDevice = aoDevice + i;
+	poDevice->oPerf = oPerf;
+	/* Evaluated before the update moves the interval on: only kept
+	   if the interval turns out continuous */
+	if (p_poMetric->n && poDevice->oPrevPerf.timestamp_ns)
+	    rMetric = MetricEval (p_poMetric, &(poDevice->oPrevPerf), &oPerf);
+	if ((status = PerfStatsUpdate (&(poDevice->oPrevPerf), &oPerf,
+				       &oStats))) {
+	    printf ("%s %" PRIu64 " %s\n", acName, oStats.iInterval_ns,
+		    (status == 2) ? "rebaseline" : "baseline");
+	    AlertReset (&(poDevice->oAlerts));
+	    continue;
+	}
+#if !SEPARATE_BUSY_TIMES
+	if (oStats.fBusyValid)
+	    PerfStatsSplitBusy (&(poDevice->oBusySplit), &oStats);
+#endif
+	PerfStatsFractions (&oStats, IO_TRANSFER, p_iMaxXferMBperSec, arIO);
+	PerfStatsFractions (&oStats, BUSY_TIME, p_iMaxXferMBperSec, arBusy);
+	printf ("%s %" PRIu64 " %.3f %.3f %.3f", acName, oStats.iInterval_ns,
+		oStats.arPerf[R_DATA], oStats.arPerf[W_DATA],
+		oStats.arPerf[RW_DATA]);
+	if (oStats.fBusyValid)
+	    printf (" %.1f %.1f %.1f", oStats.arBusy[R_DATA],
+		    oStats.arBusy[W_DATA], oStats.arBusy[RW_DATA]);
+	else
+	    printf (" - - -");
+	printf (" %.4f %.4f %.4f %.4f %.4f %.4f", arIO[R_DATA],
+		arIO[W_DATA], arIO[RW_DATA], arBusy[R_DATA], arBusy[W_DATA],
+		arBusy[RW_DATA]);
+	if (p_poMetric->n)
+	    printf (" %.6g", rMetric);
+	printf ("\n");
+	CheckAlerts (poDevice, &oStats, p_poMetric->n ? &rMetric : NULL,
+		     stdout, "");
+    }
+    if (pF != stdin)
+	fclose (pF);
+    return (0);
+  Error:
+    if (pF != stdin)
+	fclose (pF);
+    return (1);
+}				/* Replay() */
+
+	/**************************************************************/
+
+int main (int argc, char **argv)
+{
+    struct device_t aoDevice[MAX_DEVICES];
+    const char     *apcName[MAX_DEVICES];
+    struct devperf_t aoPerf[MAX_DEVICES];
+    static struct samplering_t oRing;
+    static char     acRecordBuffer[BUFSIZ];
+    struct recorder_t oRecorder;
+    pthread_t       iRecorderThread;
+    struct exporter_t oExporter;
+    struct perfstats_t oStats;
+    struct tickcost_t oCost;
+    struct tickcost_sample_t oTickCost;
+    struct devperf_cost_t oDevCost;
+    struct kreadbatch_t oKRead;
+    struct sleepwatch_t oSleepWatch;
+    struct metric_t oMetric;
+    struct alerts_t oAlerts;
+    struct timespec oNext;
+    double          rMetric = 0;
+    char            acError[64];
+    uint64_t        t0 = 0;
+    const char     *pcStatFile = 0, *pcSocket = 0, *pcRecord = 0,
+	*pcReplay = 0;
+    FILE           *pFRecord = 0;
+    long            iPeriod_ms = 1000, iCount = 0, iReport;
+    int64_t         iAllocations = 0;
+    int             iMaxXferMBperSec = 40, fCosts = 0, nDevices, status, c,
+	i, fCheckAllocations = 0, iPeriods, iAllocFailures = 0, fIoUring = 0;
+
+    memset (&oMetric, 0, sizeof (oMetric));
+    memset (&oAlerts, 0, sizeof (oAlerts));
+
+    while ((c = getopt (argc, argv, "i:c:x:e:vw:r:auhm:A:")) != -1)
+	switch (c) {
+	    case 'i':
+		iPeriod_ms = atol (optarg);
+		break;
+	    case 'c':
+		iCount = atol (optarg);
+		break;
+	    case 'x':
+		iMaxXferMBperSec = atoi (optarg);
+		break;
+	    case 'e':
+		pcSocket = optarg;
+		break;
+	    case 'v':
+		fCosts = 1;
+		break;
+	    case 'w':
+		pcRecord = optarg;
+		break;
+	    case 'r':
+		pcReplay = optarg;
+		break;
+	    case 'a':
+		fCheckAllocations = 1;
+		break;
+	    case 'u':
+		fIoUring = 1;
+		break;
+	    case 'm':
+		if (MetricCompile (&oMetric, optarg, acError,
+				   sizeof (acError))) {
+		    fprintf (stderr, "%s: %s: %s\n", PROGRAM_NAME, optarg,
+			     acError);
+		    return (2);
+		}
+		break;
+	    case 'A':
+		if (AlertCompile (&oAlerts, optarg, acError,
+				  sizeof (acError))) {
+		    fprintf (stderr, "%s: %s: %s\n", PROGRAM_NAME, optarg,
+			     acError);
+		    return (2);
+		}
+		break;
+	    case 'h':
+		Usage (stdout);
+		return (0);
+	    default:
+		Usage (stderr);
+		return (2);
+	}
+    nDevices = argc - optind;
+    if (pcReplay && !nDevices && (iMaxXferMBperSec > 0))
+	return (Replay (pcReplay, iMaxXferMBperSec, &oMetric, &oAlerts));
+    if ((nDevices < 1) || (nDevices > MAX_DEVICES) || (iPeriod_ms <= 0)
+	|| (iMaxXferMBperSec <= 0)) {
+	Usage (stderr);
+	return (2);
+    }
+
+    status = DevPerfInit ();
+    if (DevCheckStatAvailability (&pcStatFile)) {
+	fprintf (stderr, "%s: %s: %s\n", PROGRAM_NAME,
+		 pcStatFile ? pcStatFile : "",
+		 (status < 0) ? strerror (-status) :
+		 "No disk extended statistics found");
+	return (1);
+    }
+
+    memset (aoDevice, 0, sizeof (aoDevice));
+    for (i = 0; i < nDevices; i++) {
+	aoDevice[i].pcName = apcName[i] = argv[optind + i];
+	aoDevice[i].oAlerts = oAlerts;
+#if  !defined(__FreeBSD__) && !defined(__NetBSD__) && !defined(__OpenBSD__) && !defined(__sun__)
+	if (MountDevResolve (aoDevice[i].pcName, &(aoDevice[i].st_rdev))) {
+	    fprintf (stderr, "%s: %s: No such device or mount point\n",
+		     PROGRAM_NAME, aoDevice[i].pcName);
+	    return (1);
+	}
+#endif
+    }
+
+    ExporterInit (&oExporter);
+    if (pcSocket && ExporterOpen (&oExporter, pcSocket))
+	return (1);
+    if (pcRecord && !(pFRecord = fopen (pcRecord, "w"))) {
+	perror (pcRecord);
+	return (1);
+    }
+    if (pFRecord) {
+	/* Own buffer: the recorder thread allocates nothing either */
+	setvbuf (pFRecord, acRecordBuffer, _IOFBF, sizeof (acRecordBuffer));
+	memset (&oRecorder, 0, sizeof (oRecorder));
+	oRecorder.pF = pFRecord;
+	oRecorder.apcName = apcName;
+	oRecorder.poRing = &oRing;
+	oRecorder.iPeriod_ms = iPeriod_ms;
+	SampleRingInit (&oRing);
+	SampleRingAttach (&oRing, &(oRecorder.oReader), 0);
+	if ((status = pthread_create (&iRecorderThread, 0, Recorder,
+				      &oRecorder))) {
+	    fprintf (stderr, "%s: %s: %s\n", PROGRAM_NAME, pcRecord,
+		     strerror (status));
+	    return (1);
+	}
+    }
+
+    if (fCheckAllocations && (MemCountAllocations () < 0)) {
+	fprintf (stderr, "%s: Cannot count allocations on this platform\n",
+		 PROGRAM_NAME);
+	return (1);
+    }
+
+    KReadInit (&oKRead, fIoUring);
+    if (fIoUring && (oKRead.iRingFd == -1))
+	fprintf (stderr, "%s: io_uring unavailable, using pread\n",
+		 PROGRAM_NAME);
+    else if (fIoUring && DevPerfKRead ())
+	KReadAdd (&oKRead, DevPerfKRead ());
+
+    TickCostInit (&oCost);
+    DevPerfSetCostAccounting (fCosts);
+    SleepWatchInit (&oSleepWatch);
+    clock_gettime (CLOCK_MONOTONIC, &oNext);
+    for (iReport = iPeriods = 0;; iPeriods++) {
+	if (SleepWatchCheck (&oSleepWatch)) {
+	    /* The system slept: do not average over the sleep */
+	    fprintf (stderr, "%s: Woke up, new baseline\n", PROGRAM_NAME);
+	    for (i = 0; i < nDevices; i++) {
+		aoDevice[i].oPrevPerf.timestamp_ns = 0;
+		AlertReset (&(aoDevice[i].oAlerts));
+	    }
+	}
+	if (fCheckAllocations)
+	    iAllocations = MemCountAllocations ();
+	memset (&oTickCost, 0, sizeof (oTickCost));
+	if (fCosts)
+	    t0 = TickCostNow_ns ();
+	if (oKRead.n)
+	    KReadSubmit (&oKRead);
+	GetDevicesPerf (aoDevice, nDevices);
+	if (fCosts) {
+	    oTickCost.collect_ns = TickCostNow_ns () - t0;
+	    DevGetPerfCost (&oDevCost);
+	    oTickCost.parse_ns = oDevCost.parse_ns;
+	    oTickCost.syscalls = oDevCost.syscalls +
+		(oKRead.n ? oKRead.iSyscalls : 0);
+	}
+	if (pFRecord)
+	    for (i = 0; i < nDevices; i++)
+		SampleRingWrite (&oRing, i, aoDevice[i].oPrevPerf.timestamp_ns ?
+				 0 : SAMPLERING_BASELINE, &(aoDevice[i].oPerf));
+	if (oExporter.iListenFd != -1) {
+	    for (i = 0; i < nDevices; i++)
+		aoPerf[i] = aoDevice[i].oPerf;
+	    ExporterPublish (&oExporter, nDevices, apcName, aoPerf);
+	    ExporterServe (&oExporter);
+	}
+	/* The first sample only sets the baseline */
+	if (fCosts)
+	    t0 = TickCostNow_ns ();
+	for (i = 0, status = 1; i < nDevices; i++) {
+	    if (oMetric.n && aoDevice[i].oPrevPerf.timestamp_ns)
+		rMetric = MetricEval (&oMetric, &(aoDevice[i].oPrevPerf),
+				      &(aoDevice[i].oPerf));
+	    switch (PerfStatsUpdate (&(aoDevice[i].oPrevPerf),
+				     &(aoDevice[i].oPerf), &oStats)) {
+		case 0:
+#if !SEPARATE_BUSY_TIMES
+		    if (oStats.fBusyValid)
+			PerfStatsSplitBusy (&(aoDevice[i].oBusySplit),
+					    &oStats);
+#endif
+		    break;
+		case 2:
+		    fprintf (stderr, "%s: %s: Counters reset or gap,"
+			     " new baseline\n", PROGRAM_NAME,
+			     aoDevice[i].pcName);
+		    AlertReset (&(aoDevice[i].oAlerts));
+		    /* Fall through */
+		default:
+		    continue;
+	    }
+	    if (status) {
+		printf ("\n%-16s %9s %9s %9s %7s %7s %7s %5s %5s%s\n",
+			"Device", "rMiB/s", "wMiB/s", "MiB/s",
+			R_BUSY_TITLE, W_BUSY_TITLE, "busy%", "qlen", "bar%",
+			oMetric.n ? "      metric" : "");
+		status = 0;
+	    }
+	    PrintStats (aoDevice + i, &oStats, iMaxXferMBperSec, &oMetric,
+			rMetric);
+	    CheckAlerts (aoDevice + i, &oStats, oMetric.n ? &rMetric : NULL,
+			 stderr, PROGRAM_NAME ": ");
+	}
+	if (fCosts && !status) {
+	    oTickCost.render_ns = TickCostNow_ns () - t0;
+	    TickCostAdd (&oCost, &oTickCost);
+	    PrintCosts (&oCost);
+	}
+	fflush (stdout);
+	if (fCheckAllocations) {
+	    /* The first periods size the buffers: stdio, statistics file */
+	    iAllocations = MemCountAllocations () - iAllocations;
+	    if (iAllocations && (iPeriods >= ALLOC_WARMUP_PERIODS)) {
+		fprintf (stderr, "%s: Period %d: %" PRId64
+			 " heap allocations\n", PROGRAM_NAME, iPeriods,
+			 iAllocations);
+		iAllocFailures++;
+	    }
+	}
+	if (!status && (++iReport == iCount))
+	    break;
+
+	oNext.tv_nsec += (iPeriod_ms % 1000) * 1000 * 1000;
+	oNext.tv_sec += iPeriod_ms / 1000 + oNext.tv_nsec / 1000000000;
+	oNext.tv_nsec %= 1000000000;
+	while (clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &oNext, 0)
+	       == EINTR);
+    }
+
+    if (pFRecord) {
+	__atomic_store_n (&(oRecorder.fStop), 1, __ATOMIC_RELEASE);
+	pthread_join (iRecorderThread, 0);
+	fclose (pFRecord);
+    }
+    ExporterClose (&oExporter);
+    return (iAllocFailures ? 3 : 0);
+}				/* main() */
@@ -0,0 +1,293 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+	/* OpenMetrics text exporter.
+	   The counters of the last sample are formatted once per period
+	   into a fixed buffer; a scraper connecting to the Unix-domain
+	   socket gets a copy of that buffer and the connection is closed.
+	   Scraping never touches the kernel statistics file.
+	   e.g.: socat -u UNIX-CONNECT:<path> - */
+
+#include "exporter.h"
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL	0
+#endif
+
+
+typedef struct family_t {
+    const char     *pcName;
+    const char     *pcType;
+    const char     *pcUnit;
+    const char     *pcHelp;
+} family_t;
+
+enum {
+    F_READ_BYTES,
+    F_WRITTEN_BYTES,
+    F_READ_BUSY,
+    F_WRITE_BUSY,
+    F_QUEUE_LENGTH,
+    NFAMILIES
+};
+
+static const struct family_t m_aoFamily[NFAMILIES] = {
+    {"diskperf_read_bytes", "counter", "bytes",
+     "Number of bytes read from the device"},
+    {"diskperf_written_bytes", "counter", "bytes",
+     "Number of bytes written to the device"},
+    {"diskperf_read_busy_seconds", "counter", "seconds",
+     "Device read busy time"},
+    {"diskperf_write_busy_seconds", "counter", "seconds",
+     "Device write busy time"},
+    {"diskperf_queue_length", "gauge", NULL,
+     "Current queue length"}
+};
+
+	/**************************************************************/
+
+static int Append (struct exporter_t *p_poExporter, const char *p_pcFormat,
+		   ...)
+	/* Append formatted text to the served buffer */
+	/* Return 0 on success, -1 on overflow */
+{
+    size_t          iRoom = sizeof (p_poExporter->acBuffer) -
+	p_poExporter->iLength;
+    va_list         ap;
+    int             n;
+
+    va_start (ap, p_pcFormat);
+    n = vsnprintf (p_poExporter->acBuffer + p_poExporter->iLength, iRoom,
+		   p_pcFormat, ap);
+    va_end (ap);
+    if ((n < 0) || ((size_t) n >= iRoom))
+	return (-1);
+    p_poExporter->iLength += n;
+    return (0);
+}				/* Append() */
+
+
+static int AppendLabel (struct exporter_t *p_poExporter,
+			const char *p_pcDevice)
+	/* Append the device label, escaped as required by OpenMetrics */
+{
+    const char     *pc;
+    char           *pcOut = p_poExporter->acBuffer + p_poExporter->iLength,
+	*pcEnd = p_poExporter->acBuffer + sizeof (p_poExporter->acBuffer);
+
+    for (pc = p_pcDevice; *pc; pc++) {
+	if (pcEnd - pcOut < 3)
+	    return (-1);
+	switch (*pc) {
+	    case '\\':
+	    case '"':
+		*pcOut++ = '\\';
+		*pcOut++ = *pc;
+		break;
+	    case '\n':
+		*pcOut++ = '\\';
+		*pcOut++ = 'n';
+		break;
+	    default:
+		*pcOut++ = *pc;
+	}
+    }
+    p_poExporter->iLength = pcOut - p_poExporter->acBuffer;
+    return (0);
+}				/* AppendLabel() */
+
+
+static int AppendSample (struct exporter_t *p_poExporter, int p_iFamily,
+			 const char *p_pcDevice,
+			 const struct devperf_t *p_poPerf, uint64_t p_iWall_ns)
+	/* Append the sample line of a single device - p_iWall_ns turns its
+	   timestamp into wall-clock time */
+{
+    const struct family_t *poFamily = m_aoFamily + p_iFamily;
+    const char     *pcSuffix = strcmp (poFamily->pcType, "counter") ?
+	"" : "_total";
+    int             status;
+
+    if ((p_iFamily == F_QUEUE_LENGTH) && (p_poPerf->qlen < 0))
+	return (0);		/* Not provided by the kernel */
+    if (Append (p_poExporter, "%s%s{device=\"", poFamily->pcName, pcSuffix)
+	|| AppendLabel (p_poExporter, p_pcDevice))
+	return (-1);
+    switch (p_iFamily) {
+	case F_READ_BYTES:
+	    status = Append (p_poExporter, "\"} %" PRIu64, p_poPerf->rbytes);
+	    break;
+	case F_WRITTEN_BYTES:
+	    status = Append (p_poExporter, "\"} %" PRIu64, p_poPerf->wbytes);
+	    break;
+	case F_READ_BUSY:
+	    status = Append (p_poExporter, "\"} %" PRIu64 ".%09" PRIu64,
+			     p_poPerf->rbusy_ns / 1000000000,
+			     p_poPerf->rbusy_ns % 1000000000);
+	    break;
+	case F_WRITE_BUSY:
+	    status = Append (p_poExporter, "\"} %" PRIu64 ".%09" PRIu64,
+			     p_poPerf->wbusy_ns / 1000000000,
+			     p_poPerf->wbusy_ns % 1000000000);
+	    break;
+	case F_QUEUE_LENGTH:
+	default:
+	    status = Append (p_poExporter, "\"} %d", (int) p_poPerf->qlen);
+    }
+    if (status)
+	return (-1);
+    /* Sample timestamp, in seconds since the Epoch */
+    return (Append (p_poExporter, " %" PRIu64 ".%03" PRIu64 "\n",
+		    (p_poPerf->timestamp_ns + p_iWall_ns) / 1000000000,
+		    ((p_poPerf->timestamp_ns + p_iWall_ns) / 1000000) % 1000));
+}				/* AppendSample() */
+
+	/**************************************************************/
+
+void ExporterInit (struct exporter_t *p_poExporter)
+{
+    p_poExporter->iListenFd = -1;
+    p_poExporter->acPath[0] = 0;
+    p_poExporter->iLength = 0;
+}				/* ExporterInit() */
+
+
+int ExporterOpen (struct exporter_t *p_poExporter, const char *p_pcPath)
+{
+    struct sockaddr_un oAddr;
+    struct stat     oStat;
+    int             fd, flags;
+
+    ExporterClose (p_poExporter);
+    if (!p_pcPath || !*p_pcPath
+	|| (strlen (p_pcPath) >= sizeof (oAddr.sun_path)))
+	return (-1);
+
+    memset (&oAddr, 0, sizeof (oAddr));
+    oAddr.sun_family = AF_UNIX;
+    strcpy (oAddr.sun_path, p_pcPath);
+    /* Replace a socket left behind by a previous instance, but never
+       a regular file */
+    if ((lstat (p_pcPath, &oStat) == 0) && S_ISSOCK (oStat.st_mode))
+	unlink (p_pcPath);
+
+    fd = socket (AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) {
+	perror ("socket");
+	return (-1);
+    }
+    flags = fcntl (fd, F_GETFL);
+    fcntl (fd, F_SETFL, flags | O_NONBLOCK);
+    fcntl (fd, F_SETFD, FD_CLOEXEC);
+    if ((bind (fd, (struct sockaddr *) &oAddr, sizeof (oAddr)) == -1)
+	|| (listen (fd, 8) == -1)) {
+	perror (p_pcPath);
+	close (fd);
+	return (-1);
+    }
+    p_poExporter->iListenFd = fd;
+    strcpy (p_poExporter->acPath, p_pcPath);
+    return (0);
+}				/* ExporterOpen() */
+
+
+void ExporterClose (struct exporter_t *p_poExporter)
+{
+    if (p_poExporter->iListenFd == -1)
+	return;
+    close (p_poExporter->iListenFd);
+    unlink (p_poExporter->acPath);
+    p_poExporter->iListenFd = -1;
+    p_poExporter->acPath[0] = 0;
+}				/* ExporterClose() */
+
+
+int ExporterPublish (struct exporter_t *p_poExporter, int p_iNDevices,
+		     const char *const *p_ppcDevices,
+		     const struct devperf_t *p_poPerf)
+{
+    const struct family_t *poFamily;
+    struct timespec oWall, oClock;
+    uint64_t        iWall_ns;
+    int             i, j;
+
+    /* The samples are stamped on DEVPERF_CLOCK: the scrapers want the
+       wall-clock time */
+    clock_gettime (CLOCK_REALTIME, &oWall);
+    clock_gettime (DEVPERF_CLOCK, &oClock);
+    iWall_ns = ((uint64_t) 1000000000 * oWall.tv_sec + oWall.tv_nsec) -
+	((uint64_t) 1000000000 * oClock.tv_sec + oClock.tv_nsec);
+    p_poExporter->iLength = 0;
+    for (i = 0; i < NFAMILIES; i++) {
+	poFamily = m_aoFamily + i;
+	if (Append (p_poExporter, "# TYPE %s %s\n# HELP %s %s.\n",
+		    poFamily->pcName, poFamily->pcType,
+		    poFamily->pcName, poFamily->pcHelp))
+	    goto Error;
+	if (poFamily->pcUnit
+	    && Append (p_poExporter, "# UNIT %s %s\n",
+		       poFamily->pcName, poFamily->pcUnit))
+	    goto Error;
+	for (j = 0; j < p_iNDevices; j++)
+	    if (AppendSample (p_poExporter, i, p_ppcDevices[j],
+			      p_poPerf + j, iWall_ns))
+		goto Error;
+    }
+    if (!Append (p_poExporter, "# EOF\n"))
+	return (0);
+  Error:
+    p_poExporter->iLength = 0;
+    return (-1);
+}				/* ExporterPublish() */
+
+
+int ExporterServe (struct exporter_t *p_poExporter)
+{
+    int             fd, n = 0;
+
+    if (p_poExporter->iListenFd == -1)
+	return (-1);
+    while ((fd = accept (p_poExporter->iListenFd, NULL, NULL)) != -1) {
+	/* The buffer fits in the socket send buffer: a single
+	   non-blocking send never stalls the caller */
+	if (p_poExporter->iLength)
+	    (void) send (fd, p_poExporter->acBuffer, p_poExporter->iLength,
+			 MSG_DONTWAIT | MSG_NOSIGNAL);
+	close (fd);
+	n++;
+    }
+    return (((errno == EAGAIN) || (errno == EWOULDBLOCK)
+	     || (errno == EINTR)) ? n : -1);
+}				/* ExporterServe() */
@@ -0,0 +1,76 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _exporter_h
+#define _exporter_h
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+#include "devperf.h"
+
+
+#define EXPORTER_PATH_SIZE	108	/* sizeof (sockaddr_un.sun_path) */
+#define EXPORTER_BUFFER_SIZE	4096
+
+
+typedef struct exporter_t {
+    int             iListenFd;	/* -1 when the endpoint is disabled */
+    char            acPath[EXPORTER_PATH_SIZE];
+    size_t          iLength;	/* Bytes of acBuffer ready to be served */
+    char            acBuffer[EXPORTER_BUFFER_SIZE];
+    /* Latest samples, preformatted in OpenMetrics text format */
+} exporter_t;
+
+
+#ifdef __cplusplus
+extern          "C" {
+#endif
+
+    void            ExporterInit (struct exporter_t *exporter);
+    /* Reset the exporter to its disabled state */
+
+    int             ExporterOpen (struct exporter_t *exporter,
+				  const char *SocketPath);
+    /* Listen on the Unix-domain socket SocketPath (stale socket files
+       are replaced) */
+    /* Return 0 on success, -1 otherwise */
+
+    void            ExporterClose (struct exporter_t *exporter);
+    /* Stop listening and remove the socket file */
+
+    int             ExporterPublish (struct exporter_t *exporter,
+				     int NDevices,
+				     const char *const *Devices,
+				     const struct devperf_t *perf);
+    /* Format the latest counters of NDevices devices into the served
+       buffer */
+    /* Return 0 on success, -1 if the buffer is too small */
+
+    int             ExporterServe (struct exporter_t *exporter);
+    /* Accept the pending scrapers and hand them the served buffer */
+    /* Return the number of scrapers served, -1 on error */
+
+#ifdef __cplusplus
+}				/* extern "C" */
+#endif
+
+#endif				/* _exporter_h */
@@ -0,0 +1,121 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+	/* Many devices at a glance: one colour-mapped cell per device */
+
+#include "heatmap.h"
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#if !defined(__FreeBSD__) && !defined(__NetBSD__) && !defined(__OpenBSD__) && !defined(__sun__)
+#include "mountdev.h"
+#endif
+
+
+int HeatmapOpen (struct heatmap_t *p_poHeatmap, const char *p_pcDevices)
+{
+    const char     *pc = p_pcDevices;
+    char           *pcName;
+    size_t          iLength;
+#if !defined(__FreeBSD__) && !defined(__NetBSD__) && !defined(__OpenBSD__) && !defined(__sun__)
+    dev_t           iDevice;
+#endif
+    int             i;
+
+    memset (p_poHeatmap, 0, sizeof (*p_poHeatmap));
+    while (pc && *pc && (p_poHeatmap->n < HEATMAP_MAX)) {
+	pc += strspn (pc, " \t,");
+	iLength = strcspn (pc, " \t,");
+	if (!iLength)
+	    break;
+	i = p_poHeatmap->n++;
+	pcName = p_poHeatmap->aacName[i];
+	if (iLength >= sizeof (p_poHeatmap->aacName[i]))
+	    iLength = sizeof (p_poHeatmap->aacName[i]) - 1;
+	memcpy (pcName, pc, iLength);
+	pc += strcspn (pc, " \t,");
+#if defined(__FreeBSD__) || defined (__NetBSD__) || defined(__OpenBSD__) || defined(__sun__)
+	p_poHeatmap->aiSlot[i + 1] = DevStateAcquire (pcName);
+#else
+	if (MountDevResolve (pcName, &iDevice) == -1)
+	    iDevice = 0;
+	p_poHeatmap->aiSlot[i + 1] = DevStateAcquire (&iDevice);
+#endif
+    }
+    PerfBatchInit (&(p_poHeatmap->oBatch), p_poHeatmap->n);
+    for (i = 0; i < p_poHeatmap->n; i++)
+	p_poHeatmap->aiLevel[i] = -1;
+    return (p_poHeatmap->n);
+}				/* HeatmapOpen() */
+
+
+void HeatmapClose (struct heatmap_t *p_poHeatmap)
+{
+    int             i;
+
+    for (i = 0; i < p_poHeatmap->n; i++)
+	DevStateRelease (p_poHeatmap->aiSlot[i + 1]);
+    p_poHeatmap->n = 0;
+}				/* HeatmapClose() */
+
+
+void HeatmapReset (struct heatmap_t *p_poHeatmap)
+{
+    int             i;
+
+    for (i = 0; i < p_poHeatmap->n; i++)
+	DevStateReset (p_poHeatmap->aiSlot[i + 1]);
+    PerfBatchInit (&(p_poHeatmap->oBatch), p_poHeatmap->n);
+}				/* HeatmapReset() */
+
+	/**************************************************************/
+
+int HeatmapUpdate (struct heatmap_t *p_poHeatmap, int p_iSlot,
+		   enum statistics_t p_eStatistics, int p_iMaxXferMBperSec)
+	/* All the cells come from the same snapshot, so that they can be
+	   compared with each other */
+{
+    const struct devstate_t *poTable = DevStateTable ();
+    const int32_t  *aiFraction = p_poHeatmap->oBatch.aiFraction;
+    int32_t         iLevel;
+    int             i, iSlot, n = p_poHeatmap->n;
+
+    p_poHeatmap->aiSlot[0] = p_iSlot;
+    DevStateUpdate (p_poHeatmap->aiSlot, n + 1);
+    for (i = 0; i < n; i++) {
+	iSlot = p_poHeatmap->aiSlot[i + 1];
+	if (iSlot < 0) {
+	    p_poHeatmap->aiStatus[i] = -1;
+	    continue;
+	}
+	p_poHeatmap->aoPerf[i] = poTable->aoPerf[iSlot];
+	p_poHeatmap->aiStatus[i] = poTable->aiStatus[iSlot];
+    }
+    PerfBatchUpdate (&(p_poHeatmap->oBatch), p_poHeatmap->aoPerf,
+		     p_poHeatmap->aiStatus, p_eStatistics,
+		     p_iMaxXferMBperSec);
+    for (i = 0; i < n; i++) {
+	iLevel = (aiFraction[i] * HEATMAP_LEVELS) / PERFBATCH_ONE;
+	p_poHeatmap->aiLevel[i] = (int8_t) ((aiFraction[i] < 0) ? -1 :
+					    (iLevel < HEATMAP_LEVELS) ?
+					    iLevel : HEATMAP_LEVELS - 1);
+    }
+    return ((p_iSlot < 0) ? -1 : poTable->aiStatus[p_iSlot]);
+}				/* HeatmapUpdate() */
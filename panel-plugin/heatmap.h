@@ -0,0 +1,82 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _heatmap_h
+#define _heatmap_h
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <sys/types.h>
+
+#include "devperf.h"
+#include "devstate.h"
+#include "perfstats.h"
+
+
+#define HEATMAP_MAX	128	/* Devices */
+#define HEATMAP_LEVELS	16	/* Colour levels */
+
+typedef struct heatmap_t {
+    /* Devices shown as a grid of cells, collected together */
+    int             n;
+    char            aacName[HEATMAP_MAX][32];
+    int             aiSlot[HEATMAP_MAX + 1];	/* Device state slots -
+						   [0] is the caller's own
+						   device */
+    struct devperf_t aoPerf[HEATMAP_MAX];	/* Gathered from the slots */
+    int             aiStatus[HEATMAP_MAX];
+    struct perfbatch_t
+                    oBatch;	/* Fractions of the cells, aiFraction */
+    int8_t          aiLevel[HEATMAP_MAX];	/* Fraction in
+						   [0, HEATMAP_LEVELS[,
+						   -1 if unavailable */
+} heatmap_t;
+
+
+#ifdef __cplusplus
+extern          "C" {
+#endif
+
+    int             HeatmapOpen (struct heatmap_t *heatmap,
+				 const char *devices);
+    /* Set the heatmap up for the blank or comma separated list of
+       devices (device names, or on Linux device files or directories
+       standing for the device they are mounted from) - Devices that
+       cannot be resolved are kept, as unavailable cells */
+    /* Return the number of devices, at most HEATMAP_MAX */
+
+    void            HeatmapClose (struct heatmap_t *heatmap);
+    /* Release the device state slots of the heatmap */
+
+    void            HeatmapReset (struct heatmap_t *heatmap);
+    /* Forget the counters of the heatmap devices (e.g. after a system
+       sleep): the next update is a baseline */
+
+    int             HeatmapUpdate (struct heatmap_t *heatmap, int slot,
+				   enum statistics_t eStatistics,
+				   int MaxXferMBperSec);
+    /* Update the heatmap devices together with the device state slot
+       of the caller, from a single read of the kernel statistics, and
+       compute the value and colour level of each cell */
+    /* Return the DevStateUpdate() status of slot */
+
+#ifdef __cplusplus
+}				/* extern "C" */
+#endif
+
+#endif				/* _heatmap_h */
@@ -0,0 +1,103 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+	/* In-memory history of the statistics, for the detail window */
+
+#include "history.h"
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+
+void HistoryAdd (struct history_t *p_poHistory, uint64_t p_iTimestamp_ns,
+		 const struct perfstats_t *p_poStats)
+{
+    struct history_sample_t *poSample =
+	p_poHistory->aoSample + (p_poHistory->iCount % HISTORY_SIZE);
+
+    poSample->timestamp_ns = p_iTimestamp_ns;
+    poSample->arValue[H_READ_MBPS] = p_poStats->arPerf[R_DATA];
+    poSample->arValue[H_WRITE_MBPS] = p_poStats->arPerf[W_DATA];
+    poSample->arValue[H_READ_IOPS] = p_poStats->arIops[R_DATA];
+    poSample->arValue[H_WRITE_IOPS] = p_poStats->arIops[W_DATA];
+    poSample->arValue[H_AWAIT_MS] = p_poStats->rAwait_ms;
+    poSample->arValue[H_QUEUE] = p_poStats->qlen;
+    poSample->fGap = p_poHistory->fGap;
+    p_poHistory->fGap = 0;
+    p_poHistory->iCount++;
+}				/* HistoryAdd() */
+
+
+void HistoryGap (struct history_t *p_poHistory)
+{
+    if (p_poHistory->iCount)
+	p_poHistory->fGap = 1;
+}				/* HistoryGap() */
+
+
+int HistoryLength (const struct history_t *p_poHistory)
+{
+    return (p_poHistory->iCount < HISTORY_SIZE ?
+	    (int) p_poHistory->iCount : HISTORY_SIZE);
+}				/* HistoryLength() */
+
+
+const struct history_sample_t *HistorySample (const struct history_t
+					      *p_poHistory, int p_i)
+{
+    unsigned int    iFirst = p_poHistory->iCount - HistoryLength (p_poHistory);
+
+    return (p_poHistory->aoSample + ((iFirst + p_i) % HISTORY_SIZE));
+}				/* HistorySample() */
+
+
+int HistorySummary (const struct history_t *p_poHistory,
+		    struct history_sample_t *p_poAverage,
+		    struct history_sample_t *p_poMaximum)
+{
+    const struct history_sample_t *poSample;
+    double          arSum[NSERIES];
+    int             anKnown[NSERIES];
+    int             n = HistoryLength (p_poHistory), i, j;
+
+    memset (arSum, 0, sizeof (arSum));
+    memset (anKnown, 0, sizeof (anKnown));
+    memset (p_poAverage, 0, sizeof (*p_poAverage));
+    memset (p_poMaximum, 0, sizeof (*p_poMaximum));
+    for (i = 0; i < n; i++) {
+	poSample = HistorySample (p_poHistory, i);
+	for (j = 0; j < NSERIES; j++) {
+	    if (poSample->arValue[j] < 0)	/* Unknown */
+		continue;
+	    arSum[j] += poSample->arValue[j];
+	    if (!anKnown[j]++
+		|| (poSample->arValue[j] > p_poMaximum->arValue[j]))
+		p_poMaximum->arValue[j] = poSample->arValue[j];
+	}
+    }
+    for (j = 0; j < NSERIES; j++)
+	if (anKnown[j])
+	    p_poAverage->arValue[j] = arSum[j] / anKnown[j];
+	else
+	    p_poAverage->arValue[j] = p_poMaximum->arValue[j] = -1;
+    if (n)
+	p_poAverage->timestamp_ns = p_poMaximum->timestamp_ns =
+	    HistorySample (p_poHistory, n - 1)->timestamp_ns;
+    return (n);
+}				/* HistorySummary() */
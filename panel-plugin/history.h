@@ -0,0 +1,90 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _history_h
+#define _history_h
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <inttypes.h>
+
+#include "perfstats.h"
+
+
+#define HISTORY_SIZE	1024	/* Samples kept */
+
+enum {
+    /* Series of a history sample */
+    H_READ_MBPS,
+    H_WRITE_MBPS,
+    H_READ_IOPS,
+    H_WRITE_IOPS,
+    H_AWAIT_MS,
+    H_QUEUE,			/* -1 if unknown */
+    NSERIES
+};
+
+typedef struct history_sample_t {
+    uint64_t        timestamp_ns;
+    float           arValue[NSERIES];
+    int             fGap;	/* Does not follow the previous sample */
+} history_sample_t;
+
+typedef struct history_t {
+    /* Last HISTORY_SIZE statistics of a device, in memory */
+    struct history_sample_t
+                    aoSample[HISTORY_SIZE];
+    unsigned int    iCount;	/* Samples added since the start */
+    int             fGap;	/* For the next sample */
+} history_t;
+
+
+#ifdef __cplusplus
+extern          "C" {
+#endif
+
+    void            HistoryAdd (struct history_t *history,
+				uint64_t timestamp_ns,
+				const struct perfstats_t *stats);
+    /* Append the statistics of an interval ending at timestamp_ns,
+       overwriting the oldest sample once full */
+
+    void            HistoryGap (struct history_t *history);
+    /* Mark the next sample as not following the last one (e.g. device
+       counters reset): the chart is not drawn across */
+
+    int             HistoryLength (const struct history_t *history);
+    /* Return the number of samples available */
+
+    const struct history_sample_t *HistorySample (const struct history_t
+						  *history, int i);
+    /* Get the i-th sample, 0 being the oldest available */
+
+    int             HistorySummary (const struct history_t *history,
+				    struct history_sample_t *average,
+				    struct history_sample_t *maximum);
+    /* Compute the average and maximum of every series over the samples
+       available - Unknown (negative) values are left out; a series
+       without any known value gets -1 for both */
+    /* Return the number of samples available */
+
+#ifdef __cplusplus
+}				/* extern "C" */
+#endif
+
+#endif				/* _history_h */
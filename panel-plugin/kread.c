@@ -0,0 +1,282 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+	/* Batched reads of kernel statistics files. Every registered
+	   file is read from offset 0 into its own buffer; with io_uring
+	   (Linux 5.6 and later) a whole batch costs a single system call.
+	   The raw system calls are used, so that there is no dependency on
+	   liburing. */
+
+#include "kread.h"
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#if defined(__linux__) && defined(HAVE_LINUX_IO_URING_H)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(IO_URING_OP_SUPPORTED)
+#define KREAD_RING	1
+#endif
+#endif
+
+
+#if defined(KREAD_RING)
+	/**************************************************************/
+	/**************************	io_uring	***************/
+	/**************************************************************/
+
+static void *RingMap (int p_fd, size_t p_iSize, off_t p_iOffset)
+{
+    void           *pv = mmap (0, p_iSize, PROT_READ | PROT_WRITE,
+			       MAP_SHARED | MAP_POPULATE, p_fd, p_iOffset);
+    return (pv == MAP_FAILED ? 0 : pv);
+}				/* RingMap() */
+
+
+static void RingClose (struct kreadbatch_t *p_poBatch)
+{
+    if (p_poBatch->pvSqes)
+	munmap (p_poBatch->pvSqes, p_poBatch->iSqesSize);
+    if (p_poBatch->pvCqRing)
+	munmap (p_poBatch->pvCqRing, p_poBatch->iCqRingSize);
+    if (p_poBatch->pvSqRing)
+	munmap (p_poBatch->pvSqRing, p_poBatch->iSqRingSize);
+    if (p_poBatch->iRingFd != -1)
+	close (p_poBatch->iRingFd);
+    p_poBatch->pvSqes = p_poBatch->pvCqRing = p_poBatch->pvSqRing = 0;
+    p_poBatch->iRingFd = -1;
+}				/* RingClose() */
+
+
+static int RingSetup (struct kreadbatch_t *p_poBatch)
+	/* Return 0 on success, -1 otherwise */
+{
+    struct io_uring_params oParams;
+    struct {
+	struct io_uring_probe oProbe;
+	struct io_uring_probe_op aoOp[IORING_OP_READ + 1];
+    }               oProbe;
+    char           *pcSq, *pcCq;
+    int             fd;
+
+    memset (&oParams, 0, sizeof (oParams));
+    fd = syscall (__NR_io_uring_setup, KREAD_MAX, &oParams);
+    if (fd == -1)
+	return (-1);		/* Too old, or disabled (io_uring_disabled) */
+    p_poBatch->iRingFd = fd;
+    memset (&oProbe, 0, sizeof (oProbe));
+    if ((syscall (__NR_io_uring_register, fd, IORING_REGISTER_PROBE,
+		  &oProbe, IORING_OP_READ + 1) == -1)
+	|| (oProbe.oProbe.last_op < IORING_OP_READ)
+	|| !(oProbe.aoOp[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED))
+	return (-1);
+
+    p_poBatch->iSqRingSize = oParams.sq_off.array +
+	oParams.sq_entries * sizeof (uint32_t);
+    p_poBatch->iCqRingSize = oParams.cq_off.cqes +
+	oParams.cq_entries * sizeof (struct io_uring_cqe);
+    p_poBatch->iSqesSize = oParams.sq_entries * sizeof (struct io_uring_sqe);
+    if (!(p_poBatch->pvSqRing = RingMap (fd, p_poBatch->iSqRingSize,
+					 IORING_OFF_SQ_RING))
+	|| !(p_poBatch->pvCqRing = RingMap (fd, p_poBatch->iCqRingSize,
+					    IORING_OFF_CQ_RING))
+	|| !(p_poBatch->pvSqes = RingMap (fd, p_poBatch->iSqesSize,
+					  IORING_OFF_SQES)))
+	return (-1);
+    pcSq = p_poBatch->pvSqRing;
+    pcCq = p_poBatch->pvCqRing;
+    p_poBatch->piSqHead = (uint32_t *) (pcSq + oParams.sq_off.head);
+    p_poBatch->piSqTail = (uint32_t *) (pcSq + oParams.sq_off.tail);
+    p_poBatch->piSqMask = (uint32_t *) (pcSq + oParams.sq_off.ring_mask);
+    p_poBatch->piSqArray = (uint32_t *) (pcSq + oParams.sq_off.array);
+    p_poBatch->piCqHead = (uint32_t *) (pcCq + oParams.cq_off.head);
+    p_poBatch->piCqTail = (uint32_t *) (pcCq + oParams.cq_off.tail);
+    p_poBatch->piCqMask = (uint32_t *) (pcCq + oParams.cq_off.ring_mask);
+    p_poBatch->pvCqes = pcCq + oParams.cq_off.cqes;
+    return (0);
+}				/* RingSetup() */
+
+
+static int RingReap (struct kreadbatch_t *p_poBatch)
+	/* Store the results of the completed reads */
+	/* Return their number */
+{
+    const struct io_uring_cqe *poCqe, *aoCqe = p_poBatch->pvCqes;
+    uint32_t        iHead = *(p_poBatch->piCqHead);
+    int             n = 0;
+
+    for (; iHead != __atomic_load_n (p_poBatch->piCqTail,
+				     __ATOMIC_ACQUIRE); iHead++, n++) {
+	poCqe = aoCqe + (iHead & *(p_poBatch->piCqMask));
+	if (poCqe->user_data < (uint64_t) p_poBatch->n)
+	    p_poBatch->apoRead[poCqe->user_data]->iLength = poCqe->res;
+    }
+    __atomic_store_n (p_poBatch->piCqHead, iHead, __ATOMIC_RELEASE);
+    return (n);
+}				/* RingReap() */
+
+
+static void RingWait (struct kreadbatch_t *p_poBatch, int p_n,
+		      int p_nTaken)
+	/* Wait until the p_nTaken reads the kernel took, p_n of which are
+	   reaped already, are complete: they write into their buffers until
+	   then - If io_uring_enter() fails, poll the completion queue,
+	   where the kernel posts them anyway */
+{
+    const struct timespec oPoll = { 0, 1000000 };
+
+    while ((p_n += RingReap (p_poBatch)) < p_nTaken) {
+	p_poBatch->iSyscalls++;
+	if ((syscall (__NR_io_uring_enter, p_poBatch->iRingFd, 0,
+		      p_nTaken - p_n, IORING_ENTER_GETEVENTS, 0, 0) == -1)
+	    && (errno != EINTR))
+	    nanosleep (&oPoll, 0);
+    }
+}				/* RingWait() */
+
+
+static int RingSubmit (struct kreadbatch_t *p_poBatch)
+	/* Return 0 on success, -1 if the ring failed as a whole - The
+	   reads the kernel took are complete either way */
+{
+    struct io_uring_sqe *poSqe, *aoSqe = p_poBatch->pvSqes;
+    struct kread_t *poRead;
+    uint32_t        iFirst = *(p_poBatch->piSqTail), iTail = iFirst;
+    int             i, n, nTaken;
+
+    for (i = 0; i < p_poBatch->n; i++, iTail++) {
+	poRead = p_poBatch->apoRead[i];
+	poSqe = aoSqe + (iTail & *(p_poBatch->piSqMask));
+	memset (poSqe, 0, sizeof (*poSqe));
+	poSqe->opcode = IORING_OP_READ;
+	poSqe->fd = poRead->iFd;
+	poSqe->addr = (uintptr_t) poRead->pcBuffer;
+	poSqe->len = poRead->iSize - 1;
+	poSqe->off = 0;
+	poSqe->user_data = i;
+	p_poBatch->piSqArray[iTail & *(p_poBatch->piSqMask)] =
+	    iTail & *(p_poBatch->piSqMask);
+	poRead->iLength = -EIO;
+    }
+    __atomic_store_n (p_poBatch->piSqTail, iTail, __ATOMIC_RELEASE);
+
+    for (n = 0; n < p_poBatch->n;) {
+	p_poBatch->iSyscalls++;
+	/* Entries not consumed yet by the kernel (interrupted call) */
+	i = iTail - __atomic_load_n (p_poBatch->piSqHead, __ATOMIC_ACQUIRE);
+	if (syscall (__NR_io_uring_enter, p_poBatch->iRingFd, i,
+		     p_poBatch->n - n, IORING_ENTER_GETEVENTS, 0, 0) == -1) {
+	    if (errno == EINTR)
+		continue;
+	    break;
+	}
+	n += RingReap (p_poBatch);
+    }
+    if (n >= p_poBatch->n)
+	return (0);
+
+    /* The reads the kernel already took still write into their
+       buffers: wait for them before the buffers are read again, reused
+       by the pread() fallback, or the ring is closed (which would not
+       stop the reads running in the kernel workers) */
+    nTaken = __atomic_load_n (p_poBatch->piSqHead, __ATOMIC_ACQUIRE) - iFirst;
+    RingWait (p_poBatch, n, nTaken);
+    return (-1);
+}				/* RingSubmit() */
+#endif
+
+	/**************************************************************/
+
+void KReadInit (struct kreadbatch_t *p_poBatch, int p_fRing)
+{
+    memset (p_poBatch, 0, sizeof (*p_poBatch));
+    p_poBatch->iRingFd = -1;
+#if defined(KREAD_RING)
+    if (p_fRing && RingSetup (p_poBatch))
+	RingClose (p_poBatch);
+#else
+    (void) p_fRing;
+#endif
+}				/* KReadInit() */
+
+
+void KReadClose (struct kreadbatch_t *p_poBatch)
+{
+#if defined(KREAD_RING)
+    RingClose (p_poBatch);
+#endif
+    KReadReset (p_poBatch);
+}				/* KReadClose() */
+
+
+int KReadAdd (struct kreadbatch_t *p_poBatch, struct kread_t *p_poRead)
+{
+    if (p_poBatch->n >= KREAD_MAX)
+	return (-1);
+    p_poBatch->apoRead[p_poBatch->n++] = p_poRead;
+    return (0);
+}				/* KReadAdd() */
+
+
+void KReadReset (struct kreadbatch_t *p_poBatch)
+{
+    p_poBatch->n = 0;
+}				/* KReadReset() */
+
+
+int KReadSubmit (struct kreadbatch_t *p_poBatch)
+{
+    struct kread_t *poRead;
+    int             i, nFailures = 0, fDone = 0;
+
+    p_poBatch->iSyscalls = 0;
+#if defined(KREAD_RING)
+    if ((p_poBatch->iRingFd != -1) && p_poBatch->n) {
+	fDone = !RingSubmit (p_poBatch);
+	if (!fDone)
+	    /* Do not try again */
+	    RingClose (p_poBatch);
+    }
+#endif
+    for (i = 0; i < p_poBatch->n; i++) {
+	poRead = p_poBatch->apoRead[i];
+	if (!fDone) {
+	    do {
+		poRead->iLength = pread (poRead->iFd, poRead->pcBuffer,
+					 poRead->iSize - 1, 0);
+		p_poBatch->iSyscalls++;
+	    } while ((poRead->iLength == -1) && (errno == EINTR));
+	    if (poRead->iLength == -1)
+		poRead->iLength = -errno;
+	}
+	if (poRead->iLength < 0) {
+	    poRead->fReady = 0;
+	    nFailures++;
+	    continue;
+	}
+	poRead->pcBuffer[poRead->iLength] = 0;
+	poRead->fReady = 1;
+    }
+    return (nFailures);
+}				/* KReadSubmit() */
@@ -0,0 +1,85 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef _kread_h
+#define _kread_h
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+
+#define KREAD_MAX	64	/* Reads per batch */
+
+typedef struct kread_t {
+    /* Read of a kernel statistics file from offset 0 */
+    int             iFd;
+    char           *pcBuffer;
+    size_t          iSize;	/* Buffer size, including the final NUL */
+    ssize_t         iLength;	/* Bytes read, -errno on failure */
+    int             fReady;	/* Read by the last batch and not used
+				   yet - Cleared by the owner */
+} kread_t;
+
+typedef struct kreadbatch_t {
+    /* Reads issued together, through a single io_uring submission when
+       available, with pread() otherwise */
+    int             iRingFd;	/* -1 when pread() is used */
+    void           *pvSqRing, *pvCqRing, *pvSqes;
+    size_t          iSqRingSize, iCqRingSize, iSqesSize;
+    uint32_t       *piSqHead, *piSqTail, *piSqMask, *piSqArray;
+    uint32_t       *piCqHead, *piCqTail, *piCqMask;
+    void           *pvCqes;
+    struct kread_t *apoRead[KREAD_MAX];
+    int             n;
+    uint32_t        iSyscalls;	/* Issued by the last KReadSubmit() */
+} kreadbatch_t;
+
+
+#ifdef __cplusplus
+extern          "C" {
+#endif
+
+    void            KReadInit (struct kreadbatch_t *batch, int ring);
+    /* Set up an empty batch, backed by io_uring if ring is set and the
+       kernel supports it (batch->iRingFd != -1) */
+
+    void            KReadClose (struct kreadbatch_t *batch);
+    /* Release the ring; the reads themselves are left untouched */
+
+    int             KReadAdd (struct kreadbatch_t *batch,
+			      struct kread_t *read);
+    /* Register a read; its buffer may change between submissions */
+    /* Return 0 on success, -1 if the batch is full */
+
+    void            KReadReset (struct kreadbatch_t *batch);
+    /* Unregister every read */
+
+    int             KReadSubmit (struct kreadbatch_t *batch);
+    /* Issue every registered read and wait for all of them; each buffer
+       is NUL-terminated and marked ready */
+    /* Return the number of failed reads */
+
+#ifdef __cplusplus
+}				/* extern "C" */
+#endif
+
+#endif				/* _kread_h */
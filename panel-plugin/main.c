@@ -15,14 +15,31 @@
  * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
  */
 
+#include "alert.h"
+#include "cgroupio.h"
 #include "config_gui.h"
 #include "devperf.h"
+#include "devprobe.h"
+#include "devstate.h"
+#include "exporter.h"
+#include "heatmap.h"
+#include "history.h"
+#include "metric.h"
+#include "mountdev.h"
+#include "perfstats.h"
+#include "procio.h"
+#include "psi.h"
+#include "samplering.h"
+#include "sleepwatch.h"
+#include "kread.h"
+#include "tickcost.h"
 
 #ifdef HAVE_CONFIG_H
 #include <config.h>
 #endif
 
 #include <gtk/gtk.h>
+#include <glib-unix.h>
 
 #include <libxfce4util/libxfce4util.h>
 #include <libxfce4ui/libxfce4ui.h>
@@ -38,41 +55,26 @@
 #include <string.h>
 #include <errno.h>
 #include <sys/stat.h>
+#ifdef HAVE_SYS_SYSMACROS_H
+#include <sys/sysmacros.h>
+#endif
 #include <stdint.h>
 
 #define PLUGIN_NAME	"DiskPerf"
 #define BORDER          8
 
-
- /* Some platforms do not provide busy times as separate read and write
-    data, but only a single value combining both */
-#if  defined(__NetBSD__)
-#define	SEPARATE_BUSY_TIMES	0
-#elif  defined(__sun__)
-#define	SEPARATE_BUSY_TIMES	0
-#elif defined(__linux__)
-#define	SEPARATE_BUSY_TIMES	1
-#else
-#define	SEPARATE_BUSY_TIMES	1
-#endif
+#define NBARS		3	/* Read/write (or combined) + I/O pressure */
+#define PRESSURE_BAR	2
+#define PRESSURE_COLOR	"#FF8000"
+#define PRESSURE_STALL_US	150000	/* PSI trigger: 150 ms stalled */
+#define PRESSURE_WINDOW_US	2000000	/* per 2 s */
+#define IDLE_PROBE_MS		5000	/* Update period while idle */
+#define HEATMAP_CELL		6	/* Heatmap cell side, in pixels */
+#define HEATMAP_PITCH		(HEATMAP_CELL + 1)
 
 
 typedef GtkWidget *Widget_t;
 
-typedef enum statistics_t {
-    IO_TRANSFER,		/* MB transferred per second */
-    BUSY_TIME			/* Percentage of time the device has been
-				   busy */
-} statistics_t;
-
-enum {
-    /* Monitor bar data */
-    R_DATA,
-    W_DATA,
-    RW_DATA,
-    NMONITORS
-};
-
 typedef enum monitor_bar_order_t {
     RW_ORDER,
     WR_ORDER
@@ -94,6 +96,27 @@ typedef struct param_t {
     int             fRW_DataCombined;
     uint32_t        iPeriod_ms;
     GdkRGBA         aoColor[NMONITORS];
+    char            acExporterSocket[EXPORTER_PATH_SIZE];
+    /* OpenMetrics endpoint - Disabled when empty */
+    int             fShowCosts;	/* Debug: self-instrumentation tooltip */
+    int             fShowPressure;	/* I/O pressure stall bar */
+    char            acPressureCgroup[128];
+    /* cgroup2 group whose io.pressure is shown - System-wide if empty */
+    int             iIdleSamples;
+    /* Unchanged samples before slowing down to IDLE_PROBE_MS - 0: never */
+    int             fIoUring;	/* Batch the statistics reads */
+    char            acHeatmapDevices[512];
+    /* Devices shown as heatmap cells instead of the monitor bars - Bars
+       if empty */
+    struct devprobe_t
+                    oProbe;	/* Capabilities of the device, cached */
+    char            acMetric[256];
+    /* Derived metric expression (see metric.h) shown by the bars
+       instead of the selected statistics - None if empty */
+    char            acMetricName[32];	/* Its tooltip label */
+    double          rMetricMax;	/* Its full scale */
+    char            acAlerts[256];	/* Alert rules (see alert.h) - None
+					   if empty */
 } param_t;
 
 typedef struct color_selector_t {
@@ -119,19 +142,91 @@ typedef struct monitor_t {
     Widget_t        wEventBox;
     Widget_t        wBox;
     Widget_t        wTitle;
-    Widget_t        awProgressBar[2];	/* Physical (widget) bars */
+    Widget_t        awProgressBar[NBARS];	/* Physical (widget) bars */
+    Widget_t        wHeatmap;	/* Replaces the R/W bars in heatmap mode */
     struct perfbar_t
                     aoPerfBar[NMONITORS];	/* Virtual bars */
-    struct devperf_t
-                    oPrevPerf;
+    int             iSlot;	/* Device state of the monitored device
+				   (see devstate.h), -1 if none */
+    uint32_t        iSample;	/* Samples of the slot already added to
+				   the history */
+    struct psi_sample_t
+                    oPressure;
+    int             fPressureValid;
+    int             fPointerIn;	/* The tooltip may be visible */
+    char            acToolTips[512];
 } monitor_t;
 
+typedef struct procview_t {
+    /* Per-process I/O window */
+    Widget_t        wWindow;
+    Widget_t        wLabel;
+    guint           iTimerId;	/* Scans only while the window is up */
+    struct procio_t oProcIo;
+    struct cgroupio_t
+                    oCgroupIo;	/* Per control group, this device only */
+} procview_t;
+
+typedef struct detailview_t {
+    /* Detail window: history chart and statistics table */
+    Widget_t        wWindow;
+    Widget_t        wChart;
+    Widget_t        wLabel;
+} detailview_t;
+
 typedef struct diskperf_t {
     XfcePanelPlugin *plugin;
     guint           iTimerId;	/* Cyclic update */
+    int             iIdleCount;	/* Consecutive unchanged samples */
+    int             fIdle;	/* iTimerId runs at IDLE_PROBE_MS */
     struct conf_t   oConf;
     struct monitor_t
                     oMonitor;
+    struct exporter_t
+                    oExporter;
+    guint           iExporterWatchId;
+    struct tickcost_t
+                   *poCost;	/* NULL unless fShowCosts */
+    struct procview_t
+                   *poProcView;	/* NULL unless the window is open */
+    struct samplering_t
+                   *poRing;	/* Samples of the device, for the reader
+				   below */
+    struct samplering_reader_t
+                    oHistoryReader;
+    struct devperf_t
+                    oHistoryPrev;	/* Last sample read into the history */
+    struct metric_t oMetric;	/* Compiled from acMetric when the
+				   configuration is read */
+    struct devperf_t
+                    oMetricPrev;	/* Start of the next metric interval */
+    double          rMetric;	/* Metric of the last interval */
+    int             fMetricValid;
+    struct alerts_t oAlerts;	/* Compiled from acAlerts, with their
+				   firing state */
+    struct history_t
+                   *poHistory;	/* Last statistics of the device */
+    struct detailview_t
+                   *poDetailView;	/* NULL unless the window is open */
+    int             iMountFd;	/* Mount table watch, if acDevice is a */
+    guint           iMountWatchId;	/* directory */
+    struct psi_t    oPsi;	/* Opened if fShowPressure */
+    guint           iPsiWatchId;	/* PSI trigger */
+    struct kreadbatch_t
+                    oKRead;	/* Statistics files read at each update,
+				   if io_uring is enabled and available */
+    struct heatmap_t
+                   *poHeatmap;	/* NULL unless acHeatmapDevices */
+    struct sleepwatch_t
+                    oSleepWatch;	/* Sleeps logind did not report */
+    int             fAsleep;	/* Between logind PrepareForSleep
+				   signals: no timer */
+    GDBusConnection *poSystemBus;	/* NULL unless logind is watched */
+    guint           iSleepSignalId;
+    GDBusConnection *poSessionBus;	/* Notifications, NULL until
+					   connected (see
+					   ConnectSessionBus()) */
+    GCancellable   *poSessionBusCancel;	/* Connection in progress */
 } diskperf_t;
 
 	/**************************************************************/
@@ -159,133 +254,520 @@ static void UpdateProgressBars(struct diskperf_t *p_poPlugin, double rw, double
 }
 
 
+static void AppendCosts (struct diskperf_t *p_poPlugin, char *p_pcText,
+			 size_t p_iSize)
+	/* Append the self-instrumentation summary to the tooltip text */
+{
+    struct tickcost_sample_t oAverage, oMaximum;
+    size_t          n = strlen (p_pcText);
+
+    if (!TickCostSummary (p_poPlugin->poCost, &oAverage, &oMaximum))
+	return;
+    snprintf (p_pcText + n, p_iSize - n, _("\n"
+	     "----------------\n"
+	     "Plugin cost (avg/max, us)\n"
+	     "  Collect : %.1f/%.1f\n"
+	     "  Parse : %.1f/%.1f\n"
+	     "  Render : %.1f/%.1f\n"
+	     "  Syscalls : %u/%u"),
+	     oAverage.collect_ns / 1e3, oMaximum.collect_ns / 1e3,
+	     oAverage.parse_ns / 1e3, oMaximum.parse_ns / 1e3,
+	     oAverage.render_ns / 1e3, oMaximum.render_ns / 1e3,
+	     oAverage.syscalls, oMaximum.syscalls);
+}				/* AppendCosts() */
+
+
+static void AppendPressure (const struct psi_sample_t *p_poPressure,
+			    char *p_pcText, size_t p_iSize)
+	/* Append the I/O pressure stall figures to the tooltip text */
+{
+    size_t          n = strlen (p_pcText);
+
+    snprintf (p_pcText + n, p_iSize - n, _("\n"
+	     "Pressure (%c, 10s)\n"
+	     "  Some : %.2f\n"
+	     "  Full : %.2f"),
+	     '%', p_poPressure->rSome10, p_poPressure->rFull10);
+}				/* AppendPressure() */
+
+
+static void DisplayPressure (struct diskperf_t *p_poPlugin)
+	/* Update the I/O pressure bar */
+{
+    struct monitor_t *poMonitor = &(p_poPlugin->oMonitor);
+    Widget_t        wBar = poMonitor->awProgressBar[PRESSURE_BAR];
+    double          rFraction;
+
+    poMonitor->fPressureValid =
+	(PsiRead (&(p_poPlugin->oPsi), &(poMonitor->oPressure)) == 0);
+    if (!poMonitor->fPressureValid)
+	return;
+    rFraction = poMonitor->oPressure.rSome10 / 100;
+    gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (wBar),
+				   rFraction > 1 ? 1 : rFraction);
+}				/* DisplayPressure() */
+
+
+static void AppendHeatmap (const struct heatmap_t *p_poHeatmap,
+			   char *p_pcText, size_t p_iSize)
+	/* Append the hottest heatmap cell to the tooltip text */
+{
+    const int32_t  *aiFraction = p_poHeatmap->oBatch.aiFraction;
+    size_t          n = strlen (p_pcText);
+    int             i, iHottest = -1;
+
+    for (i = 0; i < p_poHeatmap->n; i++)
+	if ((iHottest == -1) || (aiFraction[i] > aiFraction[iHottest]))
+	    iHottest = i;
+    if ((iHottest == -1) || (aiFraction[iHottest] < 0))
+	return;
+    snprintf (p_pcText + n, p_iSize - n, _("\n"
+	     "Heatmap (%d devices)\n"
+	     "  Hottest : %s (%d%c)"),
+	     p_poHeatmap->n, p_poHeatmap->aacName[iHottest],
+	     (int) (100 * aiFraction[iHottest] / PERFBATCH_ONE), '%');
+}				/* AppendHeatmap() */
+
+
+static int FormatToolTip (struct diskperf_t *p_poPlugin)
+	/* Format the tooltip text of the last statistics into the
+	   per-instance buffer */
+	/* Return 0 if there is nothing to show yet */
+{
+    struct param_t *poConf = &(p_poPlugin->oConf.oParam);
+    struct monitor_t *poMonitor = &(p_poPlugin->oMonitor);
+    struct perfstats_t oStats;
+    const struct perfstats_t *poStats = &oStats;
+    char           *pcText = poMonitor->acToolTips;
+    size_t          iSize = sizeof (poMonitor->acToolTips);
+    int             status = DevStateStats (poMonitor->iSlot, &oStats);
+
+    if (status == -1) {
+	snprintf (pcText, iSize, _("%s: Device statistics unavailable."),
+		  poConf->acTitle);
+	return (1);
+    }
+    if (status)
+	return (0);
+    snprintf (pcText, iSize, _("%s\n"
+	     "----------------\n"
+	     "I/O    (MiB/s)\n"
+	     "  Read :%3.2f\n"
+	     "  Write :%3.2f\n"
+	     "  Total :%3.2f\n"
+	     "Busy time (%c)%s\n"
+	     "  Read : %3d\n"
+	     "  Write : %3d\n"
+         "  Total : %3d"),
+	     poConf->acTitle,
+	     poStats->arPerf[R_DATA],
+	     poStats->arPerf[W_DATA],
+	     poStats->arPerf[RW_DATA],
+	     '%', poStats->fBusyEstimated ? _(" - read/write estimated") : "",
+	     poStats->fBusyValid ?
+	     (int) round(poStats->arBusy[R_DATA]) : -1,
+	     poStats->fBusyValid ?
+	     (int) round(poStats->arBusy[W_DATA]) : -1,
+	     poStats->fBusyValid ? (int) round(poStats->arBusy[RW_DATA]) : -1);
+    if (p_poPlugin->oMetric.n && p_poPlugin->fMetricValid) {
+	size_t          n = strlen (pcText);
+
+	snprintf (pcText + n, iSize - n, "\n%s : %.6g",
+		  *(poConf->acMetricName) ? poConf->acMetricName :
+		  _("Metric"), p_poPlugin->rMetric);
+    }
+    if ((p_poPlugin->oPsi.iFd != -1) && poMonitor->fPressureValid)
+	AppendPressure (&(poMonitor->oPressure), pcText, iSize);
+    if (p_poPlugin->poHeatmap)
+	AppendHeatmap (p_poPlugin->poHeatmap, pcText, iSize);
+    if (p_poPlugin->poCost)
+	AppendCosts (p_poPlugin, pcText, iSize);
+    return (1);
+}				/* FormatToolTip() */
+
+
+static gboolean QueryToolTip (Widget_t p_w, gint p_x, gint p_y,
+			      gboolean p_fKeyboard, GtkTooltip *p_poToolTip,
+			      void *p_pvPlugin)
+	/* The tooltip text is only built when it is about to be shown:
+	   updating the monitor does not copy it every period */
+{
+    struct diskperf_t *poPlugin = p_pvPlugin;
+
+    if (!FormatToolTip (poPlugin))
+	return FALSE;
+    gtk_tooltip_set_text (p_poToolTip, poPlugin->oMonitor.acToolTips);
+    return TRUE;
+}				/* QueryToolTip() */
+
+
+static gboolean PointerCrossing (Widget_t p_w, GdkEventCrossing *p_poEvent,
+				 void *p_pvPlugin)
+	/* Track the pointer so that a visible tooltip follows the
+	   updates */
+{
+    struct diskperf_t *poPlugin = p_pvPlugin;
+
+    poPlugin->oMonitor.fPointerIn = (p_poEvent->type == GDK_ENTER_NOTIFY);
+    return FALSE;
+}				/* PointerCrossing() */
+
+
+static uint32_t SubmitReads (struct diskperf_t *p_poPlugin)
+	/* Read the statistics files of this update in a single batch;
+	   DevGetPerfData() and PsiRead() then use what was read */
+	/* Return the number of system calls issued */
+{
+    struct kreadbatch_t *poBatch = &(p_poPlugin->oKRead);
+    struct kread_t *poRead = DevPerfKRead ();
+
+    KReadReset (poBatch);
+    if (poRead)
+	KReadAdd (poBatch, poRead);
+    if (p_poPlugin->oPsi.iFd != -1)
+	KReadAdd (poBatch, &(p_poPlugin->oPsi.oRead));
+    KReadSubmit (poBatch);
+    return (poBatch->iSyscalls);
+}				/* SubmitReads() */
+
+
+static void UpdateDetailView (struct diskperf_t *p_poPlugin);
+
+static void SessionBusReady (GObject *p_poSource, GAsyncResult *p_poResult,
+			     gpointer p_pvPlugin)
+	/* End of ConnectSessionBus() - The plugin is gone if it was
+	   cancelled */
+{
+    struct diskperf_t *poPlugin = p_pvPlugin;
+    GDBusConnection *poBus;
+    GError         *poError = NULL;
+
+    poBus = g_bus_get_finish (p_poResult, &poError);
+    if (!poBus && g_error_matches (poError, G_IO_ERROR,
+				   G_IO_ERROR_CANCELLED)) {
+	g_clear_error (&poError);
+	return;
+    }
+    g_clear_object (&(poPlugin->poSessionBusCancel));
+    if (!poBus) {
+	g_warning ("%s", poError->message);
+	g_clear_error (&poError);
+	return;
+    }
+    poPlugin->poSessionBus = poBus;
+}				/* SessionBusReady() */
+
+static void ConnectSessionBus (struct diskperf_t *p_poPlugin)
+	/* Connect to the session bus for the alert notifications, in the
+	   background: the D-Bus handshake stays off the update path */
+{
+    if (p_poPlugin->poSessionBus || p_poPlugin->poSessionBusCancel)
+	return;
+    p_poPlugin->poSessionBusCancel = g_cancellable_new ();
+    g_bus_get (G_BUS_TYPE_SESSION, p_poPlugin->poSessionBusCancel,
+	       SessionBusReady, p_poPlugin);
+}				/* ConnectSessionBus() */
+
+static void NotifyAlerts (struct diskperf_t *p_poPlugin, uint32_t p_iFiring)
+	/* Send one desktop notification for the alert rules that fired
+	   (AlertUpdate() limits their rate) - The D-Bus call is not waited
+	   for, and the alerts are not notified while the session bus is
+	   still being connected to */
+{
+    struct param_t *poConf = &(p_poPlugin->oConf.oParam);
+    const struct alerts_t *poAlerts = &(p_poPlugin->oAlerts);
+    char            acSummary[160], acBody[ALERT_MAX_RULES * 64];
+    size_t          n = 0;
+    int             i;
+
+    for (i = 0; i < poAlerts->n; i++)
+	if ((p_iFiring & (1u << i)) && (n + 1 < sizeof (acBody))) {
+	    if (n)
+		acBody[n++] = '\n';
+	    AlertFormat (poAlerts, i, acBody + n, sizeof (acBody) - n);
+	    n += strlen (acBody + n);
+	}
+    if (!n)
+	return;
+    snprintf (acSummary, sizeof (acSummary), _("%s: %s alert"),
+	      poConf->acTitle, poConf->acDevice);
+    if (!p_poPlugin->poSessionBus) {
+	if (!p_poPlugin->poSessionBusCancel)	/* No session bus */
+	    g_warning ("%s\n%s", acSummary, acBody);
+	return;
+    }
+    g_dbus_connection_call (p_poPlugin->poSessionBus,
+			    "org.freedesktop.Notifications",
+			    "/org/freedesktop/Notifications",
+			    "org.freedesktop.Notifications", "Notify",
+			    g_variant_new ("(susssasa{sv}i)", "DiskPerf", 0,
+					   "drive-harddisk", acSummary,
+					   acBody, NULL, NULL, -1),
+			    NULL, G_DBUS_CALL_FLAGS_NONE, -1, NULL, NULL,
+			    NULL);
+}				/* NotifyAlerts() */
+
+static int AcquireDevice (struct diskperf_t *p_poPlugin)
+	/* Make sure the device state slot is the one of the configured
+	   device: a new device starts over, with an empty history */
+	/* Return the slot, -1 if none is available */
+{
+    const struct devstate_t *poTable = DevStateTable ();
+    struct param_t *poConf = &(p_poPlugin->oConf.oParam);
+    struct monitor_t *poMonitor = &(p_poPlugin->oMonitor);
+    int             iSlot = poMonitor->iSlot;
+
+#if defined(__FreeBSD__) || defined (__NetBSD__) || defined(__OpenBSD__) || defined(__sun__)
+    if ((iSlot >= 0) && !strcmp (poTable->aacDevice[iSlot], poConf->acDevice))
+	return (iSlot);
+    iSlot = DevStateAcquire (poConf->acDevice);
+#else
+    if ((iSlot >= 0) && (poTable->aiDevice[iSlot] == poConf->st_rdev))
+	return (iSlot);
+    iSlot = DevStateAcquire (&(poConf->st_rdev));
+#endif
+    DevStateRelease (poMonitor->iSlot);
+    poMonitor->iSlot = iSlot;
+    poMonitor->iSample = 0;
+    /* The readers skip the samples of the previous device */
+    SampleRingAttach (p_poPlugin->poRing, &(p_poPlugin->oHistoryReader), 0);
+    p_poPlugin->oHistoryPrev.timestamp_ns = 0;
+    p_poPlugin->poHistory->iCount = 0;
+    p_poPlugin->oMetricPrev.timestamp_ns = 0;
+    p_poPlugin->fMetricValid = 0;
+    AlertReset (&(p_poPlugin->oAlerts));
+    return (iSlot);
+}				/* AcquireDevice() */
+
+static int WatchedSlots (struct diskperf_t *p_poPlugin,
+			 const int **p_paiSlot)
+	/* Device state slots whose activity keeps the plugin out of idle
+	   mode: the device, and the heatmap devices if any */
+	/* Return their number */
+{
+    if (p_poPlugin->poHeatmap) {
+	/* [0] is the device (see HeatmapUpdate()) */
+	*p_paiSlot = p_poPlugin->poHeatmap->aiSlot;
+	return (p_poPlugin->poHeatmap->n + 1);
+    }
+    *p_paiSlot = &(p_poPlugin->oMonitor.iSlot);
+    return (1);
+}				/* WatchedSlots() */
+
+static int Changed (struct diskperf_t *p_poPlugin)
+	/* Check whether the counters of an available watched slot moved
+	   at the last update */
+{
+    const struct devstate_t *poTable = DevStateTable ();
+    const int      *aiSlot;
+    int             i, n = WatchedSlots (p_poPlugin, &aiSlot);
+
+    for (i = 0; i < n; i++)
+	if ((aiSlot[i] >= 0) && !poTable->aiStatus[aiSlot[i]]
+	    && poTable->afChanged[aiSlot[i]])
+	    return (1);
+    return (0);
+}				/* Changed() */
+
 static int DisplayPerf (struct diskperf_t *p_poPlugin)
  /* Get the last disk perfomance data, compute the statistics and update
     the panel-docked monitor bars */
+	/* Nothing is allocated from the heap here (the GTK internals
+	   aside): diskperf-cli -a checks the collection and statistics
+	   engine */
 {
-    struct devperf_t oPerf;
+    const struct devstate_t *poTable = DevStateTable ();
+    const struct devperf_t *poPerf;
+    struct perfstats_t oStats;
     struct param_t *poConf = &(p_poPlugin->oConf.oParam);
     struct monitor_t *poMonitor = &(p_poPlugin->oMonitor);
-    struct perfbar_t *poPerf = poMonitor->aoPerfBar;
 #if !defined(__FreeBSD__) && !defined(__NetBSD__) && !defined(__OpenBSD__) && !defined(__sun__)
     struct stat     oStat;
 #endif
-    uint64_t        iInterval_ns, rbytes, wbytes, iRBusy_ns, iWBusy_ns;
-    const double    K = 1.0 * 1000 * 1000 * 1000 / 1024 / 1024;
-    /* bytes/ns --> MB/s */
-    double          arPerf[NMONITORS], arBusy[NMONITORS], *prData, *pr;
-    char            acToolTips[256];
-    int             status, i;
-
-    rbytes = wbytes = iRBusy_ns = iWBusy_ns = -1;
-    memset (&oPerf, 0, sizeof (oPerf));
-    oPerf.qlen = -1;
-#if defined(__FreeBSD__) || defined (__NetBSD__) || defined(__OpenBSD__) || defined(__sun__)
-    status = DevGetPerfData (poConf->acDevice, &oPerf);
-#else
-    if (poConf->st_rdev == 0)
+    struct tickcost_t *poCost = p_poPlugin->poCost;
+    struct tickcost_sample_t oCost;
+    struct devperf_cost_t oDevCost;
+    uint64_t        t0 = 0;
+    uint32_t        iBatchSyscalls = 0;
+    double          arFraction[NMONITORS];
+    uint32_t        iFiring;
+    int             iSlot, status, fBaseline, fInterval = 0;
+
+    if (poCost)
+	t0 = TickCostNow_ns ();
+    if (p_poPlugin->oKRead.iRingFd != -1)
+	iBatchSyscalls = SubmitReads (p_poPlugin);
+#if !defined(__FreeBSD__) && !defined(__NetBSD__) && !defined(__OpenBSD__) && !defined(__sun__)
+    if ((poConf->st_rdev == 0) && (p_poPlugin->iMountFd == -1))
     poConf->st_rdev = (stat (poConf->acDevice, &oStat) == -1 ? 0 : oStat.st_rdev);
-    status = DevGetPerfData (&(poConf->st_rdev), &oPerf);
 #endif
+    iSlot = AcquireDevice (p_poPlugin);
+    if (p_poPlugin->poHeatmap) {
+	/* The heatmap devices come from the same read */
+	status = HeatmapUpdate (p_poPlugin->poHeatmap, iSlot,
+				poConf->eStatistics,
+				poConf->iMaxXferMBperSec);
+	gtk_widget_queue_draw (poMonitor->wHeatmap);
+    }
+    else
+	status = (iSlot < 0) ? -1 : DevStateUpdate (&iSlot, 1);
+    if (poCost) {
+	DevGetPerfCost (&oDevCost);
+	oCost.collect_ns = TickCostNow_ns () - t0;
+	oCost.parse_ns = oDevCost.parse_ns;
+	oCost.syscalls = oDevCost.syscalls + iBatchSyscalls;
+    }
     if (status == -1) {
-    snprintf (acToolTips, sizeof(acToolTips), _("%s: Device statistics unavailable."),
-              poConf->acTitle);
-    UpdateProgressBars(p_poPlugin, 0, 0, 0);
-    gtk_widget_set_tooltip_text(GTK_WIDGET(poMonitor->wEventBox), acToolTips);
-
+	p_poPlugin->oExporter.iLength = 0;
+	AlertReset (&(p_poPlugin->oAlerts));
+	UpdateProgressBars (p_poPlugin, 0, 0, 0);
+	if (poMonitor->fPointerIn)
+	    gtk_widget_trigger_tooltip_query (poMonitor->wEventBox);
 	return (-1);
     }
-    if (poMonitor->oPrevPerf.timestamp_ns) {
-	iInterval_ns =
-	    oPerf.timestamp_ns - poMonitor->oPrevPerf.timestamp_ns;
-	rbytes = oPerf.rbytes - poMonitor->oPrevPerf.rbytes;
-	wbytes = oPerf.wbytes - poMonitor->oPrevPerf.wbytes;
-	iRBusy_ns = oPerf.rbusy_ns - poMonitor->oPrevPerf.rbusy_ns;
-	iWBusy_ns = oPerf.wbusy_ns - poMonitor->oPrevPerf.wbusy_ns;
+    poPerf = poTable->aoPerf + iSlot;
+    /* Baseline or new interval: hand the sample to the history reader,
+       and format it for the scrapers once, whatever their number */
+    if (poTable->aiPrevTimestamp_ns[iSlot] == poPerf->timestamp_ns) {
+	fBaseline = (poTable->aiSamples[iSlot] == poMonitor->iSample);
+	fInterval = !fBaseline;
+	SampleRingWrite (p_poPlugin->poRing, 0,
+			 fBaseline ? SAMPLERING_BASELINE : 0, poPerf);
+	if (p_poPlugin->oExporter.iListenFd != -1) {
+	    const char     *pcDevice = poConf->acDevice;
+	    ExporterPublish (&(p_poPlugin->oExporter), 1, &pcDevice, poPerf);
+	}
+	if (fBaseline)
+	    AlertReset (&(p_poPlugin->oAlerts));
+	if (p_poPlugin->oMetric.n) {
+	    p_poPlugin->fMetricValid = !fBaseline
+		&& p_poPlugin->oMetricPrev.timestamp_ns;
+	    if (p_poPlugin->fMetricValid)
+		p_poPlugin->rMetric =
+		    MetricEval (&(p_poPlugin->oMetric),
+				&(p_poPlugin->oMetricPrev), poPerf);
+	    p_poPlugin->oMetricPrev = *poPerf;
+	}
     }
+    if (Changed (p_poPlugin))
+	p_poPlugin->iIdleCount = 0;
     else
-	iInterval_ns = 0;
-    poMonitor->oPrevPerf = oPerf;
-    if (!iInterval_ns)
+	p_poPlugin->iIdleCount++;
+    if (DevStateStats (iSlot, &oStats))
 	return (1);
-
-    arPerf[R_DATA] = K * rbytes / iInterval_ns;
-    arPerf[W_DATA] = K * wbytes / iInterval_ns;
-    arPerf[RW_DATA] = K * (rbytes + wbytes) / iInterval_ns;
-
-    if (oPerf.qlen < 0)
-	for (i = 0; i < NMONITORS; i++)
-	    arBusy[i] = 0;
-    else {
-	arBusy[R_DATA] = (double) 100.0 *iRBusy_ns / iInterval_ns;
-	arBusy[W_DATA] = (double) 100.0 *iWBusy_ns / iInterval_ns;
-	arBusy[RW_DATA] =
-	    (double) 100.0 *(iRBusy_ns + iWBusy_ns) / iInterval_ns;
-	for (i = 0; i < NMONITORS; i++) {
-	    pr = arBusy + i;
-	    if (*pr > 100)
-		*pr = 100;
-	}
+    if (fInterval && p_poPlugin->oAlerts.n) {
+	/* Once per interval, however many times the monitor is redrawn */
+	iFiring = AlertUpdate (&(p_poPlugin->oAlerts), &oStats,
+			       (p_poPlugin->oMetric.n
+				&& p_poPlugin->fMetricValid) ?
+			       &(p_poPlugin->rMetric) : NULL,
+			       poPerf->timestamp_ns);
+	if (iFiring)
+	    NotifyAlerts (p_poPlugin, iFiring);
     }
 
-    snprintf (acToolTips, sizeof(acToolTips), _("%s\n"
-	     "----------------\n"
-	     "I/O    (MiB/s)\n"
-	     "  Read :%3.2f\n"
-	     "  Write :%3.2f\n"
-	     "  Total :%3.2f\n"
-	     "Busy time (%c)\n"
-#if SEPARATE_BUSY_TIMES
-	     "  Read : %3d\n"
-	     "  Write : %3d\n"
-#endif
-         "  Total : %3d"),
-	     poConf->acTitle,
-	     arPerf[R_DATA],
-	     arPerf[W_DATA],
-	     arPerf[RW_DATA],
-	     '%',
-#if SEPARATE_BUSY_TIMES
-	     (oPerf.qlen >= 0) ?
-	     (int) round(arBusy[R_DATA]) : -1,
-	     (oPerf.qlen >= 0) ?
-	     (int) round(arBusy[W_DATA]) : -1,
-#endif
-	     (oPerf.qlen >= 0) ? (int) round(arBusy[RW_DATA]) : -1);
-    gtk_widget_set_tooltip_text(GTK_WIDGET(poMonitor->wEventBox), acToolTips);
-
-    switch (poConf->eStatistics) {
-	case BUSY_TIME:
-	    prData = arBusy;
-	    for (i = 0; i < NMONITORS; i++)
-		prData[i] /= 100;
-	    break;
-	case IO_TRANSFER:
-	default:
-	    prData = arPerf;
-	    for (i = 0; i < NMONITORS; i++)
-		prData[i] /= poConf->iMaxXferMBperSec;
-	    break;
+    if (poCost)
+	t0 = TickCostNow_ns ();
+    if (p_poPlugin->oPsi.iFd != -1)
+	DisplayPressure (p_poPlugin);
+    PerfStatsFractions (&oStats, poConf->eStatistics,
+			poConf->iMaxXferMBperSec, arFraction);
+    if (p_poPlugin->oMetric.n) {
+	/* All the bars show the metric */
+	arFraction[RW_DATA] = p_poPlugin->fMetricValid ?
+	    p_poPlugin->rMetric / poConf->rMetricMax : 0;
+	if (arFraction[RW_DATA] > 1)
+	    arFraction[RW_DATA] = 1;
+	else if (!(arFraction[RW_DATA] > 0))
+	    arFraction[RW_DATA] = 0;
+	arFraction[R_DATA] = arFraction[W_DATA] = arFraction[RW_DATA];
     }
-    for (i = 0; i < NMONITORS; i++) {
-	pr = prData + i;
-	if (*pr > 1)
-	    *pr = 1;
-	else if (*pr < 0)
-	    *pr = 0;
+    UpdateProgressBars(p_poPlugin, arFraction[RW_DATA], arFraction[R_DATA], arFraction[W_DATA]);
+    if (poMonitor->iSample != poTable->aiSamples[iSlot]) {
+	poMonitor->iSample = poTable->aiSamples[iSlot];
+	if (p_poPlugin->poDetailView)
+	    UpdateDetailView (p_poPlugin);
+    }
+    if (poMonitor->fPointerIn)
+	gtk_widget_trigger_tooltip_query (poMonitor->wEventBox);
+    if (poCost) {
+	oCost.render_ns = TickCostNow_ns () - t0;
+	TickCostAdd (poCost, &oCost);
     }
-    UpdateProgressBars(p_poPlugin, prData[RW_DATA], prData[R_DATA], prData[W_DATA]);
 
     return (0);
 }				/* DisplayPerf() */
 
 	/**************************************************************/
 
+static void Rebaseline (struct diskperf_t *p_poPlugin)
+	/* The system slept, or the plugin was idle: the counters moved on
+	   (or were reset) in a time the interval should not cover - Start
+	   over from the next sample */
+{
+    DevStateReset (p_poPlugin->oMonitor.iSlot);
+    if (p_poPlugin->poHeatmap)
+	HeatmapReset (p_poPlugin->poHeatmap);
+    p_poPlugin->iIdleCount = 0;
+}				/* Rebaseline() */
+
+static gboolean Timer (gpointer user_data);
+
+static void SetIdle (struct diskperf_t *p_poPlugin, int p_fIdle)
+	/* Run the update timer at IDLE_PROBE_MS while idle, at the update
+	   period otherwise */
+{
+    struct param_t *poConf = &(p_poPlugin->oConf.oParam);
+
+    p_poPlugin->fIdle = p_fIdle;
+    if (!p_poPlugin->iTimerId)	/* Asleep */
+	return;
+    g_source_remove (p_poPlugin->iTimerId);
+    p_poPlugin->iTimerId = g_timeout_add (p_fIdle ? IDLE_PROBE_MS :
+					  poConf->iPeriod_ms, Timer,
+					  p_poPlugin);
+}				/* SetIdle() */
+
+static void CheckIdle (struct diskperf_t *p_poPlugin)
+	/* Slow the timer down after IdleSamples unchanged samples, and
+	   bring it back to the update period on the first change */
+{
+    struct param_t *poConf = &(p_poPlugin->oConf.oParam);
+
+    if (!poConf->iIdleSamples)
+	return;
+    if (!p_poPlugin->fIdle
+	&& (p_poPlugin->iIdleCount >= poConf->iIdleSamples))
+	SetIdle (p_poPlugin, 1);
+    else if (p_poPlugin->fIdle && !p_poPlugin->iIdleCount)
+	SetIdle (p_poPlugin, 0);
+}				/* CheckIdle() */
+
+static void Wake (struct diskperf_t *p_poPlugin)
+	/* Activity while idle, found before it is computed: start over
+	   from a baseline at the update period, so that the first interval
+	   covers one period instead of the idle probe period, and the
+	   history shows a gap */
+{
+    Rebaseline (p_poPlugin);
+    SetIdle (p_poPlugin, 0);
+}				/* Wake() */
+
 static gboolean Timer (gpointer user_data)
 {
     struct diskperf_t *poPlugin = user_data;
-
+    const int      *aiSlot;
+    int             n;
+
+    if (SleepWatchCheck (&(poPlugin->oSleepWatch)))
+	Rebaseline (poPlugin);
+    if (poPlugin->fIdle) {
+	n = WatchedSlots (poPlugin, &aiSlot);
+	if (DevStateMoved (aiSlot, n))
+	    Wake (poPlugin);
+    }
     DisplayPerf (poPlugin);
+    CheckIdle (poPlugin);
     return TRUE;
 }
 
@@ -296,11 +778,14 @@ static void SetTimer (diskperf_t *poPlugin)
     GtkSettings *settings;
     struct param_t *poConf = &(poPlugin->oConf.oParam);
 
-    if (timerNeedsUpdate) {
-        g_source_remove (poPlugin->iTimerId);
+    if (timerNeedsUpdate || poPlugin->fIdle) {
+        if (poPlugin->iTimerId)
+            g_source_remove (poPlugin->iTimerId);
         poPlugin->iTimerId = 0;
         timerNeedsUpdate = 0;
     }
+    poPlugin->fIdle = 0;
+    poPlugin->iIdleCount = 0;
 
     /* reduce the default tooltip timeout to be smaller than the update interval otherwise
      * we won't see tooltips on GTK 2.16 or newer */
@@ -309,46 +794,843 @@ static void SetTimer (diskperf_t *poPlugin)
         g_object_set(settings, "gtk-tooltip-timeout",
                      poConf->iPeriod_ms - 10, NULL);
 
-    if (!poPlugin->iTimerId)
+    if (!poPlugin->iTimerId && !poPlugin->fAsleep)
         poPlugin->iTimerId = g_timeout_add (poConf->iPeriod_ms, Timer, poPlugin);
 }				/* SetTimer() */
 
-	/**************************************************************/
+#if defined(__linux__)
+static void PrepareForSleep (GDBusConnection *p_poBus, const gchar *p_pcSender,
+			     const gchar *p_pcPath, const gchar *p_pcInterface,
+			     const gchar *p_pcSignal, GVariant *p_poArgs,
+			     gpointer p_pvPlugin)
+	/* logind: the system is about to sleep (TRUE), or woke up (FALSE)
+	   - No update while asleep, and a new baseline on wake-up */
+{
+    struct diskperf_t *poPlugin = p_pvPlugin;
+    gboolean        fSleep;
+
+    g_variant_get (p_poArgs, "(b)", &fSleep);
+    if (fSleep) {
+	if (poPlugin->iTimerId)
+	    g_source_remove (poPlugin->iTimerId);
+	poPlugin->iTimerId = 0;
+	poPlugin->fAsleep = 1;
+	return;
+    }
+    if (!poPlugin->fAsleep)
+	return;
+    poPlugin->fAsleep = 0;
+    SleepWatchInit (&(poPlugin->oSleepWatch));
+    Rebaseline (poPlugin);
+    DisplayPerf (poPlugin);
+    SetTimer (poPlugin);
+}				/* PrepareForSleep() */
+#endif
 
-static int SetSingleBarColor (struct diskperf_t *p_poPlugin, int p_iBar)
-	/* Set the color of a single monitor bar */
+static void SetSleepWatch (diskperf_t *poPlugin)
+	/* Follow the system sleeps: through logind when available,
+	   otherwise by the clocks (see Timer()) */
 {
-#if GTK_CHECK_VERSION (3, 16, 0)
-    gchar * css;
+#if defined(__linux__)
+    GError         *poError = NULL;
 #endif
-    struct diskperf_t *poPlugin = p_poPlugin;
+
+    SleepWatchInit (&(poPlugin->oSleepWatch));
+#if defined(__linux__)
+    poPlugin->poSystemBus = g_bus_get_sync (G_BUS_TYPE_SYSTEM, NULL, &poError);
+    if (!poPlugin->poSystemBus) {
+	g_clear_error (&poError);
+	return;
+    }
+    poPlugin->iSleepSignalId =
+	g_dbus_connection_signal_subscribe (poPlugin->poSystemBus,
+					    "org.freedesktop.login1",
+					    "org.freedesktop.login1.Manager",
+					    "PrepareForSleep",
+					    "/org/freedesktop/login1", NULL,
+					    G_DBUS_SIGNAL_FLAGS_NONE,
+					    PrepareForSleep, poPlugin, NULL);
+#endif
+}				/* SetSleepWatch() */
+
+	/**************************************************************/
+
+static gboolean ServeExporter (gint fd, GIOCondition condition,
+			       gpointer user_data)
+	/* A scraper connected to the OpenMetrics endpoint: the text was
+	   formatted by the last update, a scrape only copies it */
+{
+    struct diskperf_t *poPlugin = user_data;
+
+    ExporterServe (&(poPlugin->oExporter));
+    return G_SOURCE_CONTINUE;
+}				/* ServeExporter() */
+
+static void SetExporter (diskperf_t *poPlugin)
+	/* (Re)open the OpenMetrics endpoint according to the configuration */
+{
     struct param_t *poConf = &(poPlugin->oConf.oParam);
-    struct monitor_t *poMonitor = &(poPlugin->oMonitor);
-    Widget_t       *pwBar;
+    struct exporter_t *poExporter = &(poPlugin->oExporter);
 
-    pwBar = poMonitor->aoPerfBar[p_iBar].pwBar;
+    if (poPlugin->iExporterWatchId) {
+	g_source_remove (poPlugin->iExporterWatchId);
+	poPlugin->iExporterWatchId = 0;
+    }
+    ExporterClose (poExporter);
+    if (!*(poConf->acExporterSocket))
+	return;
+    if (ExporterOpen (poExporter, poConf->acExporterSocket)) {
+	g_warning ("%s: cannot listen on %s", PLUGIN_NAME,
+		   poConf->acExporterSocket);
+	return;
+    }
+    poPlugin->iExporterWatchId =
+	g_unix_fd_add (poExporter->iListenFd, G_IO_IN, ServeExporter,
+		       poPlugin);
+}				/* SetExporter() */
+
+	/**************************************************************/
+
+static void SetCostAccounting (diskperf_t *poPlugin)
+	/* Turn on/off the self-instrumentation according to the
+	   configuration - It costs nothing unless turned on */
+{
+    struct param_t *poConf = &(poPlugin->oConf.oParam);
+
+    if (poConf->fShowCosts && !poPlugin->poCost) {
+	poPlugin->poCost = g_new (struct tickcost_t, 1);
+	TickCostInit (poPlugin->poCost);
+    }
+    else if (!poConf->fShowCosts && poPlugin->poCost) {
+	g_free (poPlugin->poCost);
+	poPlugin->poCost = NULL;
+    }
+    DevPerfSetCostAccounting (poConf->fShowCosts);
+}				/* SetCostAccounting() */
+
+	/**************************************************************/
+
+static gboolean PressureStall (gint fd, GIOCondition condition,
+			       gpointer user_data)
+	/* The PSI trigger fired: refresh right away rather than at the
+	   next period - Not while asleep (see PrepareForSleep()) */
+{
+    struct diskperf_t *poPlugin = user_data;
+
+    if (condition & G_IO_ERR) {	/* Control group removed */
+	poPlugin->iPsiWatchId = 0;
+	return G_SOURCE_REMOVE;
+    }
+    if (poPlugin->fAsleep)
+	return G_SOURCE_CONTINUE;
+    if (poPlugin->fIdle)
+	Wake (poPlugin);
+    DisplayPerf (poPlugin);
+    CheckIdle (poPlugin);
+    return G_SOURCE_CONTINUE;
+}				/* PressureStall() */
+
+static void SetPressure (diskperf_t *poPlugin)
+	/* (Re)open the I/O pressure source according to the configuration */
+{
+    struct param_t *poConf = &(poPlugin->oConf.oParam);
+    Widget_t        wBar = poPlugin->oMonitor.awProgressBar[PRESSURE_BAR];
+    int             fd;
+
+    if (poPlugin->iPsiWatchId) {
+	g_source_remove (poPlugin->iPsiWatchId);
+	poPlugin->iPsiWatchId = 0;
+    }
+    PsiClose (&(poPlugin->oPsi));
+    if (poConf->fShowPressure
+	&& (PsiOpen (&(poPlugin->oPsi), poConf->acPressureCgroup) == 0)) {
+	gtk_widget_show (wBar);
+	fd = PsiArmTrigger (&(poPlugin->oPsi), PRESSURE_STALL_US,
+			    PRESSURE_WINDOW_US);
+	if (fd != -1)
+	    poPlugin->iPsiWatchId =
+		g_unix_fd_add (fd, G_IO_PRI | G_IO_ERR, PressureStall,
+			       poPlugin);
+	return;
+    }
+    if (poConf->fShowPressure)
+	g_warning ("%s: I/O pressure information unavailable", PLUGIN_NAME);
+    gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (wBar), 0);
+    gtk_widget_hide (wBar);
+}				/* SetPressure() */
+
+
+static void SetBatchedReads (diskperf_t *poPlugin)
+	/* Set the statistics reads up for io_uring, when enabled */
+{
+    struct param_t *poConf = &(poPlugin->oConf.oParam);
+
+    KReadClose (&(poPlugin->oKRead));
+    KReadInit (&(poPlugin->oKRead), poConf->fIoUring);
+    if (poConf->fIoUring && (poPlugin->oKRead.iRingFd == -1))
+	g_warning ("%s: io_uring unavailable, using plain reads",
+		   PLUGIN_NAME);
+}				/* SetBatchedReads() */
+
+	/**************************************************************/
+
+#if !defined(__FreeBSD__) && !defined(__NetBSD__) && !defined(__OpenBSD__) && !defined(__sun__)
+static void ResolveDevice (diskperf_t *poPlugin);
+
+static gboolean MountsChanged (gint fd, GIOCondition condition,
+			       gpointer user_data)
+	/* Something was (un)mounted: the directory may live on another
+	   device now */
+{
+    ResolveDevice (user_data);
+    return G_SOURCE_CONTINUE;
+}				/* MountsChanged() */
+
+static void ResolveDevice (diskperf_t *poPlugin)
+	/* Get the device number of acDevice, which may also be a directory
+	   standing for the device it is mounted from. The resolution is
+	   redone only when the mount table changes. */
+{
+    struct param_t *poConf = &(poPlugin->oConf.oParam);
+    struct stat     oStat;
+    dev_t           iDev = 0;
+    int             fDirectory = 0;
+
+    if (stat (poConf->acDevice, &oStat) == -1)
+	iDev = 0;
+    else if (!S_ISDIR (oStat.st_mode))
+	iDev = oStat.st_rdev;
+    else {
+	fDirectory = 1;
+	if (MountDevResolve (poConf->acDevice, &iDev) == -1)
+	    iDev = 0;
+	if (poPlugin->iMountFd == -1) {
+	    poPlugin->iMountFd = MountDevWatch ();
+	    if (poPlugin->iMountFd != -1)
+		poPlugin->iMountWatchId =
+		    g_unix_fd_add (poPlugin->iMountFd, G_IO_PRI | G_IO_ERR,
+				   MountsChanged, poPlugin);
+	}
+    }
+    if ((poPlugin->iMountFd != -1) && !fDirectory) {
+	g_source_remove (poPlugin->iMountWatchId);
+	poPlugin->iMountWatchId = 0;
+	close (poPlugin->iMountFd);
+	poPlugin->iMountFd = -1;
+    }
+    poConf->st_rdev = iDev;	/* DisplayPerf() starts over if new */
+}				/* ResolveDevice() */
+
+static int ProbeDevice (diskperf_t *poPlugin)
+	/* Probe the capabilities of the device once, when it is selected -
+	   The result is kept in the rc file */
+	/* Return 1 if the device was probed, 0 if the cache was used */
+{
+    struct param_t *poConf = &(poPlugin->oConf.oParam);
+
+    if (poConf->oProbe.dev && (poConf->oProbe.dev == poConf->st_rdev))
+	return (0);
+    if (!poConf->st_rdev || DevProbe (poConf->st_rdev, &(poConf->oProbe)))
+	memset (&(poConf->oProbe), 0, sizeof (poConf->oProbe));
+    return (1);
+}				/* ProbeDevice() */
+#endif
+
+	/**************************************************************/
+
+#define PROCVIEW_LINES		10
+#define PROCVIEW_CGROUP_LINES	5
+#define PROCVIEW_MIN_PERIOD_MS	1000
+
+static size_t AppendCgroups (struct procview_t *p_poView, char *p_pcText,
+			     size_t p_n, size_t p_iSize)
+	/* Append the busiest control groups on the monitored device */
+{
+    const struct cgroupio_entry_t *apoTop[PROCVIEW_CGROUP_LINES], *poEntry;
+    const double    K = 1.0 * 1000 * 1000 * 1000 / 1024 / 1024;
+    /* bytes/ns --> MB/s */
+    const double    KIO = 1.0 * 1000 * 1000 * 1000;	/* IO/ns --> IO/s */
+    uint64_t        iInterval_ns;
+    const char     *pcPath;
+    size_t          iLength;
+    int             i, iTop;
+
+    if (CgroupIoScan (&(p_poView->oCgroupIo)) < 0)
+	return (p_n);
+    iInterval_ns = p_poView->oCgroupIo.iInterval_ns;
+    if (p_n < p_iSize)
+	p_n += snprintf (p_pcText + p_n, p_iSize - p_n,
+			 _("\nControl groups (this device)\n"
+			   "%-24s %8s %8s %6s %6s\n"),
+			 _("Group"), _("Read"), _("Write"), "r/s", "w/s");
+    if (!iInterval_ns)
+	return (p_n);
+    iTop = CgroupIoTop (&(p_poView->oCgroupIo), apoTop,
+			PROCVIEW_CGROUP_LINES);
+    for (i = 0; (i < iTop) && (p_n < p_iSize); i++) {
+	poEntry = apoTop[i];
+	pcPath = poEntry->pcPath;	/* The tail tells the most */
+	if ((iLength = strlen (pcPath)) > 24)
+	    pcPath += iLength - 24;
+	p_n += snprintf (p_pcText + p_n, p_iSize - p_n,
+			 "%-24s %8.2f %8.2f %6.0f %6.0f\n", pcPath,
+			 K * poEntry->aiOwn[CG_RBYTES] / iInterval_ns,
+			 K * poEntry->aiOwn[CG_WBYTES] / iInterval_ns,
+			 KIO * poEntry->aiOwn[CG_RIOS] / iInterval_ns,
+			 KIO * poEntry->aiOwn[CG_WIOS] / iInterval_ns);
+    }
+    if (!iTop && (p_n < p_iSize))
+	p_n += snprintf (p_pcText + p_n, p_iSize - p_n, _("No I/O.\n"));
+    return (p_n);
+}				/* AppendCgroups() */
+
+
+#if !defined(__FreeBSD__) && !defined(__NetBSD__) && !defined(__OpenBSD__) && !defined(__sun__)
+static size_t InsertProbe (const struct devprobe_t *p_poProbe,
+			   char *p_pcText, size_t p_n, size_t p_iSize)
+	/* Insert the device capabilities after the first line */
+{
+    char            acProbe[160], *pc;
+    size_t          iLength;
+
+    if (!p_poProbe->dev || (p_n >= p_iSize)
+	|| !(pc = strchr (p_pcText, '\n')))
+	return (p_n);
+    iLength = snprintf (acProbe, sizeof (acProbe),
+			_("  %s%s%s, queue depth %d, %d-byte blocks\n"),
+			p_poProbe->acModel, (*p_poProbe->acModel ? ", " : ""),
+			p_poProbe->fRotational ? _("rotational") :
+			p_poProbe->fNVMe ? "NVMe" : "SSD",
+			p_poProbe->iNrRequests,
+			p_poProbe->iLogicalBlockSize);
+    if ((iLength >= sizeof (acProbe)) || (p_n + iLength >= p_iSize))
+	return (p_n);
+    pc++;
+    memmove (pc + iLength, pc, p_n - (pc - p_pcText) + 1);
+    memcpy (pc, acProbe, iLength);
+    return (p_n + iLength);
+}				/* InsertProbe() */
+#endif
+
+
+static void UpdateProcView (struct diskperf_t *p_poPlugin)
+	/* Rescan the processes and refresh the per-process I/O window */
+{
+    struct procview_t *poView = p_poPlugin->poProcView;
+    struct param_t *poConf = &(p_poPlugin->oConf.oParam);
+    struct perfstats_t oStats;
+    const struct perfstats_t *poStats = &oStats;
+    const struct procio_entry_t *apoTop[PROCVIEW_LINES], *poEntry;
+    const double    K = 1.0 * 1000 * 1000 * 1000 / 1024 / 1024;
+    /* bytes/ns --> MB/s */
+    char            acText[256 + 64 * (PROCVIEW_LINES +
+				       PROCVIEW_CGROUP_LINES)];
+    size_t          n;
+    int             i, iTop, iProcesses;
+
+    if (DevStateStats (p_poPlugin->oMonitor.iSlot, &oStats))
+	memset (&oStats, 0, sizeof (oStats));
+    iProcesses = ProcIoScan (&(poView->oProcIo));
+    n = snprintf (acText, sizeof (acText), _("%s (%s)\n"
+		  "  Read : %3.2f MiB/s\n"
+		  "  Write : %3.2f MiB/s\n\n"
+		  "Processes (all devices, MiB/s)\n"
+		  "%7s %-15s %8s %8s\n"),
+		  poConf->acTitle, poConf->acDevice,
+		  poStats->arPerf[R_DATA], poStats->arPerf[W_DATA],
+		  "PID", _("Command"), _("Read"), _("Write"));
+#if !defined(__FreeBSD__) && !defined(__NetBSD__) && !defined(__OpenBSD__) && !defined(__sun__)
+    n = InsertProbe (&(poConf->oProbe), acText, n, sizeof (acText));
+#endif
+    if (iProcesses < 0)
+	n += snprintf (acText + n, sizeof (acText) - n,
+		       _("Per-process statistics unavailable.\n"));
+    else if (!poView->oProcIo.iInterval_ns)
+	n += snprintf (acText + n, sizeof (acText) - n, _("Sampling...\n"));
+    else {
+	iTop = ProcIoTop (&(poView->oProcIo), apoTop, PROCVIEW_LINES);
+	for (i = 0; (i < iTop) && (n < sizeof (acText)); i++) {
+	    poEntry = apoTop[i];
+	    n += snprintf (acText + n, sizeof (acText) - n,
+			   "%7d %-15s %8.2f %8.2f\n", (int) poEntry->pid,
+			   poEntry->acComm,
+			   K * poEntry->drbytes / poEntry->iInterval_ns,
+			   K * poEntry->dwbytes / poEntry->iInterval_ns);
+	}
+	if (!iTop && (n < sizeof (acText)))
+	    n += snprintf (acText + n, sizeof (acText) - n, _("No I/O.\n"));
+    }
+    n = AppendCgroups (poView, acText, n, sizeof (acText));
+    if (n && (n <= sizeof (acText)) && (acText[n - 1] == '\n'))
+	acText[n - 1] = 0;
+    gtk_label_set_text (GTK_LABEL (poView->wLabel), acText);
+}				/* UpdateProcView() */
+
+
+static gboolean ProcViewTimer (gpointer user_data)
+{
+    struct diskperf_t *poPlugin = user_data;
+
+    UpdateProcView (poPlugin);
+    return TRUE;
+}				/* ProcViewTimer() */
+
+
+static void CloseProcView (Widget_t p_w, void *p_pvPlugin)
+	/* The per-process I/O window is gone: stop scanning */
+{
+    struct diskperf_t *poPlugin = p_pvPlugin;
+    struct procview_t *poView = poPlugin->poProcView;
+
+    if (!poView)
+	return;
+    if (poView->iTimerId)
+	g_source_remove (poView->iTimerId);
+    ProcIoClose (&(poView->oProcIo));
+    CgroupIoClose (&(poView->oCgroupIo));
+    g_free (poView);
+    poPlugin->poProcView = NULL;
+}				/* CloseProcView() */
+
+
+static void ToggleProcView (struct diskperf_t *p_poPlugin)
+	/* Open the per-process I/O window, or close it if already open */
+{
+    struct procview_t *poView;
+    PangoAttrList  *poAttributes;
+    uint32_t        iPeriod_ms;
+
+    if (p_poPlugin->poProcView) {
+	gtk_widget_destroy (p_poPlugin->poProcView->wWindow);
+	return;
+    }
+    poView = g_new0 (struct procview_t, 1);
+    p_poPlugin->poProcView = poView;
+    ProcIoOpen (&(poView->oProcIo));
+#if !defined(__FreeBSD__) && !defined(__NetBSD__) && !defined(__OpenBSD__) && !defined(__sun__)
+    CgroupIoOpen (&(poView->oCgroupIo), p_poPlugin->oConf.oParam.st_rdev,
+		  p_poPlugin->oConf.oParam.fIoUring);
+#else
+    CgroupIoOpen (&(poView->oCgroupIo), 0, 0);
+#endif
+
+    poView->wWindow = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+    gtk_window_set_title (GTK_WINDOW (poView->wWindow),
+			  _("Disk I/O by process"));
+    gtk_window_set_icon_name (GTK_WINDOW (poView->wWindow),
+			      "drive-harddisk");
+    gtk_window_set_type_hint (GTK_WINDOW (poView->wWindow),
+			      GDK_WINDOW_TYPE_HINT_UTILITY);
+    gtk_window_set_position (GTK_WINDOW (poView->wWindow),
+			     GTK_WIN_POS_MOUSE);
+    gtk_container_set_border_width (GTK_CONTAINER (poView->wWindow),
+				    BORDER);
+
+    poView->wLabel = gtk_label_new (NULL);
+    poAttributes = pango_attr_list_new ();
+    pango_attr_list_insert (poAttributes,
+			    pango_attr_family_new ("monospace"));
+    gtk_label_set_attributes (GTK_LABEL (poView->wLabel), poAttributes);
+    pango_attr_list_unref (poAttributes);
+    gtk_label_set_xalign (GTK_LABEL (poView->wLabel), 0);
+    gtk_container_add (GTK_CONTAINER (poView->wWindow), poView->wLabel);
+
+    g_signal_connect (G_OBJECT (poView->wWindow), "destroy",
+		      G_CALLBACK (CloseProcView), p_poPlugin);
+
+    UpdateProcView (p_poPlugin);
+    gtk_widget_show_all (poView->wWindow);
+
+    iPeriod_ms = p_poPlugin->oConf.oParam.iPeriod_ms;
+    if (iPeriod_ms < PROCVIEW_MIN_PERIOD_MS)
+	iPeriod_ms = PROCVIEW_MIN_PERIOD_MS;
+    poView->iTimerId = g_timeout_add (iPeriod_ms, ProcViewTimer,
+				      p_poPlugin);
+}				/* ToggleProcView() */
+
+
+static void ToggleDetailView (struct diskperf_t *p_poPlugin);
+
+static gboolean ClickMonitor (Widget_t p_w, GdkEventButton *p_poEvent,
+			      void *p_pvPlugin)
+	/* Left (per-process I/O) or middle (details) click on the monitor
+	   bars */
+{
+    if (p_poEvent->type != GDK_BUTTON_PRESS)
+	return FALSE;
+    if (p_poEvent->button == 1)
+	ToggleProcView (p_pvPlugin);
+    else if (p_poEvent->button == 2)
+	ToggleDetailView (p_pvPlugin);
+    else
+	return FALSE;
+    return TRUE;
+}				/* ClickMonitor() */
+
+
+static void ShowProcView (Widget_t p_w, void *p_pvPlugin)
+	/* Panel menu entry */
+{
+    struct diskperf_t *poPlugin = p_pvPlugin;
+
+    if (poPlugin->poProcView)
+	gtk_window_present (GTK_WINDOW (poPlugin->poProcView->wWindow));
+    else
+	ToggleProcView (poPlugin);
+}				/* ShowProcView() */
+
+	/**************************************************************/
+
+#define DETAIL_STRIPS		4
+#define DETAIL_STRIP_HEIGHT	72
+#define DETAIL_GAP		6
+
+static const int m_aaiStripSeries[DETAIL_STRIPS][2] = {
+    /* Series drawn in each strip of the chart, -1 if none */
+    {H_READ_MBPS, H_WRITE_MBPS},
+    {H_READ_IOPS, H_WRITE_IOPS},
+    {H_AWAIT_MS, -1},
+    {H_QUEUE, -1}
+};
+
+static const char *SeriesName (int p_iSeries)
+{
+    switch (p_iSeries) {
+	case H_READ_MBPS:
+	    return (_("Read (MiB/s)"));
+	case H_WRITE_MBPS:
+	    return (_("Write (MiB/s)"));
+	case H_READ_IOPS:
+	    return (_("Read (IO/s)"));
+	case H_WRITE_IOPS:
+	    return (_("Write (IO/s)"));
+	case H_AWAIT_MS:
+	    return (_("Await (ms)"));
+	case H_QUEUE:
+	default:
+	    return (_("Queue"));
+    }
+}				/* SeriesName() */
+
+
+static const char *SeriesValue (char *p_pcText, size_t p_iSize,
+				float p_rValue)
+	/* Format a value of the detail table, "-" if unknown (negative,
+	   see H_QUEUE) */
+{
+    if (p_rValue < 0)
+	return ("-");
+    snprintf (p_pcText, p_iSize, "%.2f", p_rValue);
+    return (p_pcText);
+}				/* SeriesValue() */
+
+
+static void DrawSeries (cairo_t *p_poCairo, const struct history_t *p_poHistory,
+			int p_iSeries, double p_rMax, int p_iWidth, int p_y,
+			int p_iHeight)
+	/* Draw one series as a polyline, the last sample at the right
+	   edge, one sample per half pixel */
+{
+    const double    dx = (double) p_iWidth / (HISTORY_SIZE - 1);
+    const struct history_sample_t *poSample;
+    int             n = HistoryLength (p_poHistory), i, fGap = 1;
+    double          x, y;
+
+    for (i = 0; i < n; i++) {
+	poSample = HistorySample (p_poHistory, i);
+	if (poSample->arValue[p_iSeries] < 0) {	/* Unknown */
+	    fGap = 1;
+	    continue;
+	}
+	x = p_iWidth - (n - 1 - i) * dx;
+	y = p_y + p_iHeight * (1 - poSample->arValue[p_iSeries] / p_rMax);
+	if (!fGap && !poSample->fGap)	/* Not across gaps */
+	    cairo_line_to (p_poCairo, x, y);
+	else
+	    cairo_move_to (p_poCairo, x, y);
+	fGap = 0;
+    }
+    cairo_stroke (p_poCairo);
+}				/* DrawSeries() */
+
+
+static void ReadHistory (struct diskperf_t *p_poPlugin)
+	/* Bring the history up to date with the sample ring - Only done
+	   for the detail window: a reader left behind for longer than the
+	   ring lasts starts over from the oldest sample kept */
+{
+    struct samplering_reader_t *poReader = &(p_poPlugin->oHistoryReader);
+    struct perfstats_t oStats;
+    struct devperf_t oPerf;
+    uint64_t        iSkipped = poReader->iSkipped;
+    uint32_t        iDevice, iFlags;
+
+    while (SampleRingRead (p_poPlugin->poRing, poReader, &iDevice, &iFlags,
+			   &oPerf)) {
+	if (poReader->iSkipped != iSkipped) {
+	    iSkipped = poReader->iSkipped;
+	    p_poPlugin->oHistoryPrev.timestamp_ns = 0;
+	    p_poPlugin->poHistory->iCount = 0;
+	}
+	if (iFlags & SAMPLERING_BASELINE) {
+	    p_poPlugin->oHistoryPrev.timestamp_ns = 0;
+	    HistoryGap (p_poPlugin->poHistory);
+	}
+	switch (PerfStatsUpdate (&(p_poPlugin->oHistoryPrev), &oPerf,
+				 &oStats)) {
+	    case 0:
+		HistoryAdd (p_poPlugin->poHistory, oPerf.timestamp_ns,
+			    &oStats);
+		break;
+	    case 2:		/* Counters reset or gap */
+		HistoryGap (p_poPlugin->poHistory);
+		break;
+	}
+    }
+}				/* ReadHistory() */
+
+
+static gboolean DrawDetailChart (Widget_t p_w, cairo_t *p_poCairo,
+				 void *p_pvPlugin)
+	/* Only called while the window is visible */
+{
+    struct diskperf_t *poPlugin = p_pvPlugin;
+    const struct history_t *poHistory = poPlugin->poHistory;
+    const GdkRGBA  *aoColor = poPlugin->oConf.oParam.aoColor;
+    const GdkRGBA  *poColor;
+    struct history_sample_t oAverage, oMaximum;
+    int             iWidth = gtk_widget_get_allocated_width (p_w);
+    int             iHeight, i, j, k, y;
+    char            acText[64];
+    double          rMax;
+
+    iHeight = (gtk_widget_get_allocated_height (p_w)
+	       - (DETAIL_STRIPS - 1) * DETAIL_GAP) / DETAIL_STRIPS;
+    HistorySummary (poHistory, &oAverage, &oMaximum);
+    cairo_set_line_width (p_poCairo, 1);
+    for (i = 0; i < DETAIL_STRIPS; i++) {
+	y = i * (iHeight + DETAIL_GAP);
+	rMax = 0;
+	for (j = 0; j < 2; j++)
+	    if (((k = m_aaiStripSeries[i][j]) != -1)
+		&& (oMaximum.arValue[k] > rMax))
+		rMax = oMaximum.arValue[k];
+	if (rMax <= 0)
+	    rMax = 1;
+	cairo_set_source_rgba (p_poCairo, 0.5, 0.5, 0.5, 0.15);
+	cairo_rectangle (p_poCairo, 0, y, iWidth, iHeight);
+	cairo_fill (p_poCairo);
+	for (j = 0; j < 2; j++) {
+	    if ((k = m_aaiStripSeries[i][j]) == -1)
+		continue;
+	    poColor = (m_aaiStripSeries[i][1] == -1) ? aoColor + RW_DATA :
+		aoColor + (j ? W_DATA : R_DATA);
+	    cairo_set_source_rgb (p_poCairo, poColor->red, poColor->green,
+				  poColor->blue);
+	    DrawSeries (p_poCairo, poHistory, k, rMax, iWidth, y, iHeight);
+	}
+	snprintf (acText, sizeof (acText), "%s - max %.1f",
+		  SeriesName (m_aaiStripSeries[i][0]), rMax);
+	cairo_set_source_rgba (p_poCairo, 0.5, 0.5, 0.5, 1);
+	cairo_move_to (p_poCairo, 4, y + 12);
+	cairo_show_text (p_poCairo, acText);
+    }
+    return TRUE;
+}				/* DrawDetailChart() */
+
+
+static void UpdateDetailView (struct diskperf_t *p_poPlugin)
+	/* Refresh the detail window from the history - Nothing is done
+	   while it is not visible (e.g. minimized) */
+{
+    struct detailview_t *poView = p_poPlugin->poDetailView;
+    struct param_t *poConf = &(p_poPlugin->oConf.oParam);
+    const struct history_t *poHistory = p_poPlugin->poHistory;
+    struct history_sample_t oAverage, oMaximum;
+    const struct history_sample_t *poLast, *poFirst;
+    char            acText[128 + 64 * NSERIES];
+    char            aacValue[3][16];
+    size_t          n;
+    int             iLength, i;
+
+    if (!gtk_widget_get_mapped (poView->wWindow))
+	return;
+    ReadHistory (p_poPlugin);
+    gtk_widget_queue_draw (poView->wChart);
+    iLength = HistorySummary (poHistory, &oAverage, &oMaximum);
+    if (!iLength) {
+	gtk_label_set_text (GTK_LABEL (poView->wLabel), _("Sampling..."));
+	return;
+    }
+    poFirst = HistorySample (poHistory, 0);
+    poLast = HistorySample (poHistory, iLength - 1);
+    n = snprintf (acText, sizeof (acText), _("%s (%s) - last %d s\n"
+		  "%-14s %10s %10s %10s"),
+		  poConf->acTitle, poConf->acDevice,
+		  (int) ((poLast->timestamp_ns - poFirst->timestamp_ns)
+			 / 1000000000), "", _("Current"), _("Average"),
+		  _("Maximum"));
+    for (i = 0; (i < NSERIES) && (n < sizeof (acText)); i++)
+	n += snprintf (acText + n, sizeof (acText) - n,
+		       "\n%-14s %10s %10s %10s", SeriesName (i),
+		       SeriesValue (aacValue[0], sizeof (aacValue[0]),
+				    poLast->arValue[i]),
+		       SeriesValue (aacValue[1], sizeof (aacValue[1]),
+				    oAverage.arValue[i]),
+		       SeriesValue (aacValue[2], sizeof (aacValue[2]),
+				    oMaximum.arValue[i]));
+    gtk_label_set_text (GTK_LABEL (poView->wLabel), acText);
+}				/* UpdateDetailView() */
+
+
+static void MapDetailView (Widget_t p_w, void *p_pvPlugin)
+	/* The window (re)appears: catch up with the history */
+{
+    UpdateDetailView (p_pvPlugin);
+}				/* MapDetailView() */
+
+
+static void CloseDetailView (Widget_t p_w, void *p_pvPlugin)
+{
+    struct diskperf_t *poPlugin = p_pvPlugin;
+
+    g_free (poPlugin->poDetailView);
+    poPlugin->poDetailView = NULL;
+}				/* CloseDetailView() */
+
+
+static void ToggleDetailView (struct diskperf_t *p_poPlugin)
+	/* Open the detail window, or close it if already open - It only
+	   shows the history DisplayPerf() keeps, and reads nothing itself */
+{
+    struct detailview_t *poView;
+    Widget_t        wBox;
+    PangoAttrList  *poAttributes;
+
+    if (p_poPlugin->poDetailView) {
+	gtk_widget_destroy (p_poPlugin->poDetailView->wWindow);
+	return;
+    }
+    poView = g_new0 (struct detailview_t, 1);
+    p_poPlugin->poDetailView = poView;
+
+    poView->wWindow = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+    gtk_window_set_title (GTK_WINDOW (poView->wWindow),
+			  _("Disk I/O details"));
+    gtk_window_set_icon_name (GTK_WINDOW (poView->wWindow),
+			      "drive-harddisk");
+    gtk_window_set_type_hint (GTK_WINDOW (poView->wWindow),
+			      GDK_WINDOW_TYPE_HINT_UTILITY);
+    gtk_window_set_position (GTK_WINDOW (poView->wWindow),
+			     GTK_WIN_POS_MOUSE);
+    gtk_container_set_border_width (GTK_CONTAINER (poView->wWindow),
+				    BORDER);
+
+    wBox = gtk_box_new (GTK_ORIENTATION_VERTICAL, BORDER);
+    gtk_container_add (GTK_CONTAINER (poView->wWindow), wBox);
+
+    poView->wChart = gtk_drawing_area_new ();
+    gtk_widget_set_size_request (poView->wChart, HISTORY_SIZE / 2,
+				 DETAIL_STRIPS * DETAIL_STRIP_HEIGHT +
+				 (DETAIL_STRIPS - 1) * DETAIL_GAP);
+    g_signal_connect (G_OBJECT (poView->wChart), "draw",
+		      G_CALLBACK (DrawDetailChart), p_poPlugin);
+    gtk_box_pack_start (GTK_BOX (wBox), poView->wChart, TRUE, TRUE, 0);
+
+    poView->wLabel = gtk_label_new (NULL);
+    poAttributes = pango_attr_list_new ();
+    pango_attr_list_insert (poAttributes,
+			    pango_attr_family_new ("monospace"));
+    gtk_label_set_attributes (GTK_LABEL (poView->wLabel), poAttributes);
+    pango_attr_list_unref (poAttributes);
+    gtk_label_set_xalign (GTK_LABEL (poView->wLabel), 0);
+    gtk_box_pack_start (GTK_BOX (wBox), poView->wLabel, FALSE, FALSE, 0);
+
+    g_signal_connect (G_OBJECT (poView->wWindow), "map",
+		      G_CALLBACK (MapDetailView), p_poPlugin);
+    g_signal_connect (G_OBJECT (poView->wWindow), "destroy",
+		      G_CALLBACK (CloseDetailView), p_poPlugin);
+
+    gtk_widget_show_all (poView->wWindow);
+}				/* ToggleDetailView() */
+
+
+static void ShowDetailView (Widget_t p_w, void *p_pvPlugin)
+	/* Panel menu entry */
+{
+    struct diskperf_t *poPlugin = p_pvPlugin;
+
+    if (poPlugin->poDetailView)
+	gtk_window_present (GTK_WINDOW (poPlugin->poDetailView->wWindow));
+    else
+	ToggleDetailView (poPlugin);
+}				/* ShowDetailView() */
+
+	/**************************************************************/
+
+#define RGBA_STRING_SIZE	64
+
+static const char *RgbaToString (const GdkRGBA *p_poColor, char *p_pcBuffer)
+	/* Same text as gdk_rgba_to_string(), into a buffer of
+	   RGBA_STRING_SIZE bytes instead of a new string */
+{
+    char            acAlpha[G_ASCII_DTOSTR_BUF_SIZE];
+
+#define CHANNEL(x)	((int) (0.5 + CLAMP ((x), 0., 1.) * 255.))
+    if (p_poColor->alpha > 0.999)
+	snprintf (p_pcBuffer, RGBA_STRING_SIZE, "rgb(%d,%d,%d)",
+		  CHANNEL (p_poColor->red), CHANNEL (p_poColor->green),
+		  CHANNEL (p_poColor->blue));
+    else {
+	g_ascii_formatd (acAlpha, sizeof (acAlpha), "%g",
+			 CLAMP (p_poColor->alpha, 0, 1));
+	snprintf (p_pcBuffer, RGBA_STRING_SIZE, "rgba(%d,%d,%d,%s)",
+		  CHANNEL (p_poColor->red), CHANNEL (p_poColor->green),
+		  CHANNEL (p_poColor->blue), acAlpha);
+    }
+#undef CHANNEL
+    return (p_pcBuffer);
+}				/* RgbaToString() */
+
+
+static void SetBarColor (Widget_t *p_pwBar, const GdkRGBA *p_poColor)
+	/* Set the color of a progress bar widget */
+{
 #if GTK_CHECK_VERSION (3, 16, 0)
+    char            acCss[128 + RGBA_STRING_SIZE];
+    char            acColor[RGBA_STRING_SIZE];
+
 #if GTK_CHECK_VERSION (3, 20, 0)
-    css = g_strdup_printf("progressbar progress { background-color: %s; background-image: none; }",
+    snprintf (acCss, sizeof (acCss), "progressbar progress { background-color: %s; background-image: none; }",
 #else
-    css = g_strdup_printf(".progressbar progress { background-color: %s; background-image: none; }",
+    snprintf (acCss, sizeof (acCss), ".progressbar progress { background-color: %s; background-image: none; }",
 #endif
-                                  gdk_rgba_to_string(&poConf->aoColor[p_iBar]));
+                                  RgbaToString (p_poColor, acColor));
     /* Setup Gtk style */
-    DBG("setting css to %s for bar %d", css, p_iBar);
-    gtk_css_provider_load_from_data (g_object_get_data(G_OBJECT(*pwBar),"css_provider"), css, strlen(css), NULL);
-    g_free(css);
+    DBG("setting css to %s", acCss);
+    gtk_css_provider_load_from_data (g_object_get_data(G_OBJECT(*p_pwBar),"css_provider"), acCss, strlen(acCss), NULL);
 #else
-	gtk_widget_override_background_color(GTK_WIDGET(*pwBar),
+	gtk_widget_override_background_color(GTK_WIDGET(*p_pwBar),
 						 GTK_STATE_PRELIGHT,
-						 &poConf->aoColor[p_iBar]);
-	gtk_widget_override_background_color(GTK_WIDGET(*pwBar),
+						 p_poColor);
+	gtk_widget_override_background_color(GTK_WIDGET(*p_pwBar),
 						 GTK_STATE_SELECTED,
-						 &poConf->aoColor[p_iBar]);
-	gtk_widget_override_color(GTK_WIDGET(*pwBar),
+						 p_poColor);
+	gtk_widget_override_color(GTK_WIDGET(*p_pwBar),
 						 GTK_STATE_SELECTED,
-						 &poConf->aoColor[p_iBar]);
+						 p_poColor);
 #endif
+}				/* SetBarColor() */
+
+
+static int SetSingleBarColor (struct diskperf_t *p_poPlugin, int p_iBar)
+	/* Set the color of a single monitor bar */
+{
+    struct param_t *poConf = &(p_poPlugin->oConf.oParam);
+    struct monitor_t *poMonitor = &(p_poPlugin->oMonitor);
+
+    SetBarColor (poMonitor->aoPerfBar[p_iBar].pwBar,
+		 &poConf->aoColor[p_iBar]);
     return (0);
 }				/* SetSingleBarColor() */
 
@@ -393,6 +1675,87 @@ static int ResetMonitorBar (struct diskperf_t *p_poPlugin)
 
 	/**************************************************************/
 
+static int HeatmapLines (struct diskperf_t *p_poPlugin, int p_iWidth,
+			 int p_iHeight, int *p_pfHorizontal)
+	/* Number of cell lines fitting across the panel: the cells fill
+	   the lines one after the other, and the lines grow along the
+	   panel */
+{
+    GtkOrientation  iOrientation =
+	gtk_orientable_get_orientation (GTK_ORIENTABLE
+					(p_poPlugin->oMonitor.wBox));
+    int             iLines;
+
+    *p_pfHorizontal = (iOrientation == GTK_ORIENTATION_HORIZONTAL);
+    iLines = (*p_pfHorizontal ? p_iHeight : p_iWidth) / HEATMAP_PITCH;
+    return (iLines < 1 ? 1 : iLines);
+}				/* HeatmapLines() */
+
+
+static gboolean DrawHeatmap (Widget_t p_w, cairo_t *p_poCairo,
+			     void *p_pvPlugin)
+	/* Draw all the cells of the last update in a single pass: one
+	   path, filled once, per colour level */
+{
+    struct diskperf_t *poPlugin = p_pvPlugin;
+    const struct heatmap_t *poHeatmap = poPlugin->poHeatmap;
+    const GdkRGBA  *poColor = poPlugin->oConf.oParam.aoColor + RW_DATA;
+    int             aiCount[HEATMAP_LEVELS + 1];
+    int             i, l, x, y, iLines, fHorizontal;
+
+    if (!poHeatmap || !poHeatmap->n)
+	return FALSE;
+    iLines = HeatmapLines (poPlugin, gtk_widget_get_allocated_width (p_w),
+			   gtk_widget_get_allocated_height (p_w),
+			   &fHorizontal);
+    /* Level l + 1, 0 standing for unavailable cells */
+    memset (aiCount, 0, sizeof (aiCount));
+    for (i = 0; i < poHeatmap->n; i++)
+	aiCount[poHeatmap->aiLevel[i] + 1]++;
+    for (l = 0; l <= HEATMAP_LEVELS; l++) {
+	if (!aiCount[l])
+	    continue;
+	for (i = 0; i < poHeatmap->n; i++) {
+	    if (poHeatmap->aiLevel[i] + 1 != l)
+		continue;
+	    x = (i / iLines) * HEATMAP_PITCH;
+	    y = (i % iLines) * HEATMAP_PITCH;
+	    if (fHorizontal)
+		cairo_rectangle (p_poCairo, x, y, HEATMAP_CELL, HEATMAP_CELL);
+	    else
+		cairo_rectangle (p_poCairo, y, x, HEATMAP_CELL, HEATMAP_CELL);
+	}
+	if (l)
+	    cairo_set_source_rgba (p_poCairo, poColor->red, poColor->green,
+				   poColor->blue,
+				   0.15 + 0.85 * (l - 1) / (HEATMAP_LEVELS - 1));
+	else
+	    cairo_set_source_rgba (p_poCairo, 0.5, 0.5, 0.5, 0.3);
+	cairo_fill (p_poCairo);
+    }
+    return TRUE;
+}				/* DrawHeatmap() */
+
+
+static void SizeHeatmap (struct diskperf_t *p_poPlugin, int p_iAcross)
+	/* Request the length of panel the cells need, p_iAcross pixels
+	   being available across it */
+{
+    int             iLines, iLength, fHorizontal;
+
+    iLines = HeatmapLines (p_poPlugin, p_iAcross, p_iAcross, &fHorizontal);
+    iLength = (p_poPlugin->poHeatmap->n + iLines - 1) / iLines
+	* HEATMAP_PITCH;
+    if (fHorizontal)
+	gtk_widget_set_size_request (p_poPlugin->oMonitor.wHeatmap,
+				     iLength, -1);
+    else
+	gtk_widget_set_size_request (p_poPlugin->oMonitor.wHeatmap,
+				     -1, iLength);
+}				/* SizeHeatmap() */
+
+	/**************************************************************/
+
 static int CreateMonitorBars (struct diskperf_t *p_poPlugin,
 			      GtkOrientation p_iOrientation)
 	/* Create the panel progressive bars */
@@ -403,6 +1766,7 @@ static int CreateMonitorBars (struct diskperf_t *p_poPlugin,
     struct diskperf_t *poPlugin = p_poPlugin;
     struct param_t *poConf = &(poPlugin->oConf.oParam);
     struct monitor_t *poMonitor = &(poPlugin->oMonitor);
+    GdkRGBA         oPressureColor;
     Widget_t       *pwBar;
     int             i;
     DBG("!");
@@ -419,7 +1783,7 @@ static int CreateMonitorBars (struct diskperf_t *p_poPlugin,
     gtk_box_pack_start (GTK_BOX (poMonitor->wBox),
 			GTK_WIDGET (poMonitor->wTitle), FALSE, FALSE, 2);
 
-    for (i = 0; i < 2; i++) {
+    for (i = 0; i < NBARS; i++) {
 	pwBar = poMonitor->awProgressBar + i;
 	*pwBar = GTK_WIDGET (gtk_progress_bar_new ());
 	gtk_orientable_set_orientation (GTK_ORIENTABLE(*pwBar), !p_iOrientation);
@@ -449,7 +1813,8 @@ static int CreateMonitorBars (struct diskperf_t *p_poPlugin,
 	g_object_set_data(G_OBJECT(*pwBar), "css_provider", css_provider);
 #endif
 
-	if ((i == 1) && poConf->fRW_DataCombined)
+	if (((i == 1) && poConf->fRW_DataCombined)
+	    || ((i == PRESSURE_BAR) && !poConf->fShowPressure))
 	    gtk_widget_hide (GTK_WIDGET (*pwBar));
 	else
 	    gtk_widget_show (GTK_WIDGET (*pwBar));
@@ -457,6 +1822,14 @@ static int CreateMonitorBars (struct diskperf_t *p_poPlugin,
 			    GTK_WIDGET (*pwBar), FALSE, FALSE, 0);
     }
 
+    poMonitor->wHeatmap = gtk_drawing_area_new ();
+    g_signal_connect (G_OBJECT (poMonitor->wHeatmap), "draw",
+		      G_CALLBACK (DrawHeatmap), poPlugin);
+    gtk_box_pack_start (GTK_BOX (poMonitor->wBox),
+			GTK_WIDGET (poMonitor->wHeatmap), FALSE, FALSE, 0);
+
+    gdk_rgba_parse (&oPressureColor, PRESSURE_COLOR);
+    SetBarColor (poMonitor->awProgressBar + PRESSURE_BAR, &oPressureColor);
     ResetMonitorBar (poPlugin);
 
     return (0);
@@ -482,6 +1855,9 @@ static diskperf_t *diskperf_create_control (XfcePanelPlugin *plugin)
     poMonitor = &(poPlugin->oMonitor);
 
     poPlugin->plugin = plugin;
+    poPlugin->poHistory = g_new0 (history_t, 1);
+    poPlugin->poRing = g_new0 (samplering_t, 1);
+    SampleRingAttach (poPlugin->poRing, &(poPlugin->oHistoryReader), 0);
     
 #if defined(__NetBSD__) || defined(__OpenBSD__)
     strncpy (poConf->acDevice, "wd0", 128);
@@ -506,16 +1882,34 @@ static diskperf_t *diskperf_create_control (XfcePanelPlugin *plugin)
     gdk_rgba_parse (poConf->aoColor + RW_DATA, "#00FF00");
 
     poConf->iMaxXferMBperSec = 40;
+#if !defined(__FreeBSD__) && !defined(__NetBSD__) && !defined(__OpenBSD__) && !defined(__sun__)
+    if (poConf->st_rdev && (DevProbe (poConf->st_rdev, &(poConf->oProbe)) == 0))
+	poConf->iMaxXferMBperSec = DevProbeMaxXfer (&(poConf->oProbe));
+#endif
     poConf->fRW_DataCombined = 1;
     poConf->iPeriod_ms = 500;
     poConf->eStatistics = IO_TRANSFER;
+    poConf->rMetricMax = 100;
     poConf->eMonitorBarOrder = RW_ORDER;
     poPlugin->iTimerId = 0;
-    poPlugin->oMonitor.oPrevPerf.timestamp_ns = 0;
+    poMonitor->iSlot = -1;
+    ExporterInit (&(poPlugin->oExporter));
+    PsiInit (&(poPlugin->oPsi));
+    KReadInit (&(poPlugin->oKRead), 0);
+    poPlugin->iMountFd = -1;
 
     poMonitor->wEventBox = gtk_event_box_new ();
     gtk_event_box_set_visible_window(GTK_EVENT_BOX(poMonitor->wEventBox), FALSE);
     gtk_event_box_set_above_child(GTK_EVENT_BOX(poMonitor->wEventBox), TRUE);
+    gtk_widget_set_has_tooltip (poMonitor->wEventBox, TRUE);
+    gtk_widget_add_events (poMonitor->wEventBox,
+			   GDK_ENTER_NOTIFY_MASK | GDK_LEAVE_NOTIFY_MASK);
+    g_signal_connect (G_OBJECT (poMonitor->wEventBox), "query-tooltip",
+		      G_CALLBACK (QueryToolTip), poPlugin);
+    g_signal_connect (G_OBJECT (poMonitor->wEventBox), "enter-notify-event",
+		      G_CALLBACK (PointerCrossing), poPlugin);
+    g_signal_connect (G_OBJECT (poMonitor->wEventBox), "leave-notify-event",
+		      G_CALLBACK (PointerCrossing), poPlugin);
     gtk_widget_show (poMonitor->wEventBox);
 
     xfce_panel_plugin_add_action_widget (plugin, poMonitor->wEventBox);
@@ -530,6 +1924,39 @@ static void diskperf_free (XfcePanelPlugin *plugin, diskperf_t *poPlugin)
 {
     if (poPlugin->iTimerId)
 	g_source_remove (poPlugin->iTimerId);
+    if (poPlugin->poSystemBus) {
+	g_dbus_connection_signal_unsubscribe (poPlugin->poSystemBus,
+					      poPlugin->iSleepSignalId);
+	g_object_unref (poPlugin->poSystemBus);
+    }
+    if (poPlugin->poSessionBusCancel) {
+	g_cancellable_cancel (poPlugin->poSessionBusCancel);
+	g_object_unref (poPlugin->poSessionBusCancel);
+    }
+    if (poPlugin->poSessionBus)
+	g_object_unref (poPlugin->poSessionBus);
+    if (poPlugin->iExporterWatchId)
+	g_source_remove (poPlugin->iExporterWatchId);
+    ExporterClose (&(poPlugin->oExporter));
+    if (poPlugin->poProcView)
+	gtk_widget_destroy (poPlugin->poProcView->wWindow);
+    if (poPlugin->poDetailView)
+	gtk_widget_destroy (poPlugin->poDetailView->wWindow);
+    if (poPlugin->iPsiWatchId)
+	g_source_remove (poPlugin->iPsiWatchId);
+    if (poPlugin->iMountWatchId)
+	g_source_remove (poPlugin->iMountWatchId);
+    if (poPlugin->iMountFd != -1)
+	close (poPlugin->iMountFd);
+    PsiClose (&(poPlugin->oPsi));
+    KReadClose (&(poPlugin->oKRead));
+    if (poPlugin->poHeatmap)
+	HeatmapClose (poPlugin->poHeatmap);
+    g_free (poPlugin->poHeatmap);
+    DevStateRelease (poPlugin->oMonitor.iSlot);
+    g_free (poPlugin->poHistory);
+    g_free (poPlugin->poRing);
+    g_free (poPlugin->poCost);
     g_free (poPlugin);
 }				/* diskperf_free() */
 
@@ -547,6 +1974,24 @@ static void diskperf_free (XfcePanelPlugin *plugin, diskperf_t *poPlugin)
 #define CONF_READ_COLOR		"ReadColor"
 #define CONF_WRITE_COLOR	"WriteColor"
 #define CONF_READ_WRITE_COLOR	"ReadWriteColor"
+#define CONF_EXPORTER_SOCKET	"ExporterSocket"
+#define CONF_SHOW_COSTS		"ShowCosts"
+#define CONF_SHOW_PRESSURE	"ShowPressure"
+#define CONF_PRESSURE_CGROUP	"PressureCgroup"
+#define CONF_IDLE_SAMPLES	"IdleSamples"
+#define CONF_IO_URING		"IoUring"
+#define CONF_HEATMAP_DEVICES	"HeatmapDevices"
+#define CONF_PROBE_DEVICE	"ProbeDevice"
+#define CONF_PROBE_ROTATIONAL	"ProbeRotational"
+#define CONF_PROBE_NVME		"ProbeNVMe"
+#define CONF_PROBE_MAX_HW_KB	"ProbeMaxHwSectorsKB"
+#define CONF_PROBE_NR_REQUESTS	"ProbeNrRequests"
+#define CONF_PROBE_BLOCK_SIZE	"ProbeLogicalBlockSize"
+#define CONF_PROBE_MODEL	"ProbeModel"
+#define CONF_METRIC		"Metric"
+#define CONF_METRIC_NAME	"MetricName"
+#define CONF_METRIC_MAX		"MetricMax"
+#define CONF_ALERTS		"Alerts"
 
 	/**************************************************************/
 
@@ -563,8 +2008,7 @@ static void diskperf_read_config (XfcePanelPlugin *plugin,
     struct monitor_t *poMonitor = &(poPlugin->oMonitor);
     Widget_t       *pw2ndBar = poPlugin->oMonitor.awProgressBar + 1;
 #if !defined(__FreeBSD__) && !defined(__NetBSD__) && !defined(__OpenBSD__) && !defined(__sun__)
-    struct stat     oStat;
-    int             status;
+    unsigned int    iMajor, iMinor;
 #endif
     
     if (!(file = xfce_panel_plugin_lookup_rc_file (plugin)))
@@ -580,8 +2024,7 @@ static void diskperf_read_config (XfcePanelPlugin *plugin,
         memset (poConf->acDevice, 0, sizeof (poConf->acDevice));
         strncpy (poConf->acDevice, value, sizeof (poConf->acDevice) - 1);
 #if !defined(__FreeBSD__) && !defined(__NetBSD__) && !defined(__OpenBSD__) && !defined(__sun__)
-        status = stat (poConf->acDevice, &oStat);
-        poConf->st_rdev = (status == -1 ? 0 : oStat.st_rdev);
+        ResolveDevice (poPlugin);
 #endif
     }
 
@@ -612,7 +2055,8 @@ static void diskperf_read_config (XfcePanelPlugin *plugin,
         xfce_rc_read_int_entry (rc, (CONF_STATISTICS), IO_TRANSFER);
 
     poConf->iMaxXferMBperSec = 
-        xfce_rc_read_int_entry (rc, (CONF_XFER_RATE), 40);
+        xfce_rc_read_int_entry (rc, (CONF_XFER_RATE),
+                                poConf->iMaxXferMBperSec);
 
     poConf->fRW_DataCombined = 
         xfce_rc_read_int_entry (rc, (CONF_COMBINE_RW_DATA), 1);
@@ -636,6 +2080,96 @@ static void diskperf_read_config (XfcePanelPlugin *plugin,
     if ((value = xfce_rc_read_entry (rc, (CONF_READ_WRITE_COLOR), NULL))) {
         gdk_rgba_parse (poConf->aoColor + RW_DATA, value);
     }
+
+    if ((value = xfce_rc_read_entry (rc, (CONF_EXPORTER_SOCKET), NULL))) {
+        memset (poConf->acExporterSocket, 0,
+                sizeof (poConf->acExporterSocket));
+        strncpy (poConf->acExporterSocket, value,
+                 sizeof (poConf->acExporterSocket) - 1);
+    }
+
+    poConf->fShowCosts = 
+        xfce_rc_read_int_entry (rc, (CONF_SHOW_COSTS), 0);
+
+    poConf->fShowPressure = 
+        xfce_rc_read_int_entry (rc, (CONF_SHOW_PRESSURE), 0);
+
+    if ((value = xfce_rc_read_entry (rc, (CONF_PRESSURE_CGROUP), NULL))) {
+        memset (poConf->acPressureCgroup, 0,
+                sizeof (poConf->acPressureCgroup));
+        strncpy (poConf->acPressureCgroup, value,
+                 sizeof (poConf->acPressureCgroup) - 1);
+    }
+
+    poConf->iIdleSamples = 
+        xfce_rc_read_int_entry (rc, (CONF_IDLE_SAMPLES), 0);
+    if (poConf->iIdleSamples < 0)
+        poConf->iIdleSamples = 0;
+
+    poConf->fIoUring = 
+        xfce_rc_read_int_entry (rc, (CONF_IO_URING), 0);
+
+    if ((value = xfce_rc_read_entry (rc, (CONF_HEATMAP_DEVICES), NULL))) {
+        memset (poConf->acHeatmapDevices, 0,
+                sizeof (poConf->acHeatmapDevices));
+        strncpy (poConf->acHeatmapDevices, value,
+                 sizeof (poConf->acHeatmapDevices) - 1);
+    }
+
+    if ((value = xfce_rc_read_entry (rc, (CONF_METRIC), NULL))) {
+        char            acError[64];
+
+        memset (poConf->acMetric, 0, sizeof (poConf->acMetric));
+        strncpy (poConf->acMetric, value, sizeof (poConf->acMetric) - 1);
+        /* Parsed once here: the updates only run the compiled code */
+        if (*(poConf->acMetric)
+            && (MetricCompile (&(poPlugin->oMetric), poConf->acMetric,
+                               acError, sizeof (acError)) == -1))
+            g_warning ("%s: %s", CONF_METRIC, acError);
+    }
+    if ((value = xfce_rc_read_entry (rc, (CONF_METRIC_NAME), NULL))) {
+        memset (poConf->acMetricName, 0, sizeof (poConf->acMetricName));
+        strncpy (poConf->acMetricName, value,
+                 sizeof (poConf->acMetricName) - 1);
+    }
+    poConf->rMetricMax = 100;
+    if ((value = xfce_rc_read_entry (rc, (CONF_METRIC_MAX), NULL))
+        && (g_ascii_strtod (value, NULL) > 0))
+        poConf->rMetricMax = g_ascii_strtod (value, NULL);
+
+    if ((value = xfce_rc_read_entry (rc, (CONF_ALERTS), NULL))) {
+        char            acError[64];
+
+        memset (poConf->acAlerts, 0, sizeof (poConf->acAlerts));
+        strncpy (poConf->acAlerts, value, sizeof (poConf->acAlerts) - 1);
+        if (AlertCompile (&(poPlugin->oAlerts), poConf->acAlerts, acError,
+                          sizeof (acError)) == -1)
+            g_warning ("%s: %s", CONF_ALERTS, acError);
+        else if (poPlugin->oAlerts.n)
+            ConnectSessionBus (poPlugin);
+    }
+
+#if !defined(__FreeBSD__) && !defined(__NetBSD__) && !defined(__OpenBSD__) && !defined(__sun__)
+    if ((value = xfce_rc_read_entry (rc, (CONF_PROBE_DEVICE), NULL))
+        && (sscanf (value, "%u:%u", &iMajor, &iMinor) == 2)) {
+        struct devprobe_t *poProbe = &(poConf->oProbe);
+
+        memset (poProbe, 0, sizeof (*poProbe));
+        poProbe->dev = makedev (iMajor, iMinor);
+        poProbe->fRotational =
+            xfce_rc_read_int_entry (rc, (CONF_PROBE_ROTATIONAL), 0);
+        poProbe->fNVMe = xfce_rc_read_int_entry (rc, (CONF_PROBE_NVME), 0);
+        poProbe->iMaxHwSectors_kB =
+            xfce_rc_read_int_entry (rc, (CONF_PROBE_MAX_HW_KB), -1);
+        poProbe->iNrRequests =
+            xfce_rc_read_int_entry (rc, (CONF_PROBE_NR_REQUESTS), -1);
+        poProbe->iLogicalBlockSize =
+            xfce_rc_read_int_entry (rc, (CONF_PROBE_BLOCK_SIZE), -1);
+        if ((value = xfce_rc_read_entry (rc, (CONF_PROBE_MODEL), NULL)))
+            strncpy (poProbe->acModel, value, sizeof (poProbe->acModel) - 1);
+    }
+    ProbeDevice (poPlugin);
+#endif
     ResetMonitorBar (poPlugin);
 
     xfce_rc_close (rc);
@@ -651,6 +2185,8 @@ static void diskperf_write_config (XfcePanelPlugin *plugin,
     struct param_t *poConf = &(poPlugin->oConf.oParam);
     XfceRc *rc;
     char *file;
+    char            acColor[RGBA_STRING_SIZE];
+    char            acMetricMax[G_ASCII_DTOSTR_BUF_SIZE];
 
     if (!(file = xfce_panel_plugin_save_location (plugin, TRUE)))
         return;
@@ -679,9 +2215,53 @@ static void diskperf_write_config (XfcePanelPlugin *plugin,
     xfce_rc_write_int_entry (rc, CONF_MONITOR_BAR_ORDER, 
                              poConf->eMonitorBarOrder);
 
-    xfce_rc_write_entry (rc, CONF_READ_COLOR, gdk_rgba_to_string(poConf->aoColor + R_DATA));
-    xfce_rc_write_entry (rc, CONF_WRITE_COLOR, gdk_rgba_to_string(poConf->aoColor + W_DATA));
-    xfce_rc_write_entry (rc, CONF_READ_WRITE_COLOR, gdk_rgba_to_string(poConf->aoColor + RW_DATA));
+    xfce_rc_write_entry (rc, CONF_READ_COLOR, RgbaToString (poConf->aoColor + R_DATA, acColor));
+    xfce_rc_write_entry (rc, CONF_WRITE_COLOR, RgbaToString (poConf->aoColor + W_DATA, acColor));
+    xfce_rc_write_entry (rc, CONF_READ_WRITE_COLOR, RgbaToString (poConf->aoColor + RW_DATA, acColor));
+
+    xfce_rc_write_entry (rc, CONF_EXPORTER_SOCKET, poConf->acExporterSocket);
+
+    xfce_rc_write_int_entry (rc, CONF_SHOW_COSTS, poConf->fShowCosts);
+
+    xfce_rc_write_int_entry (rc, CONF_SHOW_PRESSURE, poConf->fShowPressure);
+    xfce_rc_write_entry (rc, CONF_PRESSURE_CGROUP, poConf->acPressureCgroup);
+
+    xfce_rc_write_int_entry (rc, CONF_IDLE_SAMPLES, poConf->iIdleSamples);
+
+    xfce_rc_write_int_entry (rc, CONF_IO_URING, poConf->fIoUring);
+
+    xfce_rc_write_entry (rc, CONF_HEATMAP_DEVICES, poConf->acHeatmapDevices);
+
+    xfce_rc_write_entry (rc, CONF_METRIC, poConf->acMetric);
+    xfce_rc_write_entry (rc, CONF_METRIC_NAME, poConf->acMetricName);
+    xfce_rc_write_entry (rc, CONF_METRIC_MAX,
+                         g_ascii_formatd (acMetricMax, sizeof (acMetricMax),
+                                          "%g", poConf->rMetricMax));
+
+    xfce_rc_write_entry (rc, CONF_ALERTS, poConf->acAlerts);
+
+#if !defined(__FreeBSD__) && !defined(__NetBSD__) && !defined(__OpenBSD__) && !defined(__sun__)
+    if (poConf->oProbe.dev) {
+        const struct devprobe_t *poProbe = &(poConf->oProbe);
+        char            acBuffer[32];
+
+        snprintf (acBuffer, sizeof (acBuffer), "%u:%u",
+                  major (poProbe->dev), minor (poProbe->dev));
+        xfce_rc_write_entry (rc, CONF_PROBE_DEVICE, acBuffer);
+        xfce_rc_write_int_entry (rc, CONF_PROBE_ROTATIONAL,
+                                 poProbe->fRotational);
+        xfce_rc_write_int_entry (rc, CONF_PROBE_NVME, poProbe->fNVMe);
+        xfce_rc_write_int_entry (rc, CONF_PROBE_MAX_HW_KB,
+                                 poProbe->iMaxHwSectors_kB);
+        xfce_rc_write_int_entry (rc, CONF_PROBE_NR_REQUESTS,
+                                 poProbe->iNrRequests);
+        xfce_rc_write_int_entry (rc, CONF_PROBE_BLOCK_SIZE,
+                                 poProbe->iLogicalBlockSize);
+        xfce_rc_write_entry (rc, CONF_PROBE_MODEL, poProbe->acModel);
+    }
+    else
+        xfce_rc_delete_entry (rc, CONF_PROBE_DEVICE, FALSE);
+#endif
 
     xfce_rc_close (rc);
 }				/* diskperf_write_config() */
@@ -695,15 +2275,22 @@ static void SetDevice (Widget_t p_wTF, void *p_pvPlugin)
     struct diskperf_t *poPlugin = (diskperf_t *) p_pvPlugin;
     struct param_t *poConf = &(poPlugin->oConf.oParam);
     const char     *pcDevice = gtk_entry_get_text (GTK_ENTRY (p_wTF));
-#if !defined(__FreeBSD__) && !defined(__NetBSD__) && !defined(__OpenBSD__) && !defined(__sun__)
-    struct stat     oStat;
-    int             status;
 
-    status = stat (pcDevice, &oStat);
-    poConf->st_rdev = oStat.st_rdev;
-#endif
     memset (poConf->acDevice, 0, sizeof (poConf->acDevice));
     strncpy (poConf->acDevice, pcDevice, sizeof (poConf->acDevice) - 1);
+#if !defined(__FreeBSD__) && !defined(__NetBSD__) && !defined(__OpenBSD__) && !defined(__sun__)
+    ResolveDevice (poPlugin);
+    if (ProbeDevice (poPlugin) && poConf->oProbe.dev) {
+	/* New device: derive the full scale from its capabilities */
+	char            acBuffer[16];
+
+	poConf->iMaxXferMBperSec = DevProbeMaxXfer (&(poConf->oProbe));
+	snprintf (acBuffer, sizeof (acBuffer), "%d",
+		  poConf->iMaxXferMBperSec);
+	gtk_entry_set_text (GTK_ENTRY (poPlugin->oConf.oGUI.wTF_MaxXfer),
+			    acBuffer);
+    }
+#endif
 }				/* SetDevice() */
 
 	/**************************************************************/
@@ -798,7 +2385,8 @@ static void ToggleRWintegration (Widget_t p_w, void *p_pvPlugin)
     else {
 	gtk_widget_hide (GTK_WIDGET (poGUI->wTa_SingleBar));
 	gtk_widget_show (GTK_WIDGET (poGUI->wTa_DualBars));
-	gtk_widget_show (GTK_WIDGET (*pw2ndBar));
+	if (!poPlugin->poHeatmap)
+	    gtk_widget_show (GTK_WIDGET (*pw2ndBar));
     }
     SetMonitorBarColor (poPlugin);
 }				/* ToggleRWintegration() */
@@ -870,7 +2458,7 @@ static void ChooseColor (Widget_t p_wPB, void *p_pvPlugin)
     else
 	return;
     gtk_color_chooser_get_rgba(GTK_COLOR_CHOOSER(p_wPB), &poColor);
-    DBG("color changed to %s for monitor %d", gdk_rgba_to_string(&poColor), iPerfBar);
+    DBG("color changed for monitor %d", iPerfBar);
     poConf->aoColor[iPerfBar] = poColor;
     SetMonitorBarColor (poPlugin);
 }				/* ChooseColor() */
@@ -1110,10 +2698,12 @@ static gboolean diskperf_set_size (XfcePanelPlugin *plugin, int p_size,
         size2 = 8;
         gtk_widget_set_size_request (GTK_WIDGET (plugin), p_size, -1);
     }
-    for (i = 0; i < 2; i++) {
+    for (i = 0; i < NBARS; i++) {
 	pwBar = poPlugin->oMonitor.awProgressBar + i;
 	gtk_widget_set_size_request (GTK_WIDGET (*pwBar), size1, size2);
     }
+    if (poPlugin->poHeatmap)
+	SizeHeatmap (poPlugin, p_size - 2 * (p_size > 26 ? 2 : 1));
 
     return TRUE;
 }				/* diskperf_set_size() */
@@ -1139,7 +2729,7 @@ static void diskperf_set_mode (XfcePanelPlugin *plugin,
 
     gtk_orientable_set_orientation(GTK_ORIENTABLE(poMonitor->wBox), p_iOrientation);
 
-    for (i = 0; i < 2; i++) {
+    for (i = 0; i < NBARS; i++) {
 	pwBar = poPlugin->oMonitor.awProgressBar + i;
 	gtk_orientable_set_orientation (GTK_ORIENTABLE(*pwBar), !p_iOrientation);
 	gtk_progress_bar_set_inverted (GTK_PROGRESS_BAR(*pwBar),
@@ -1159,9 +2749,47 @@ static void diskperf_set_mode (XfcePanelPlugin *plugin,
 }				/* diskperf_set_orientation() */
 	/**************************************************************/
 
+static void SetHeatmap (diskperf_t *poPlugin)
+	/* Switch between the monitor bars and the heatmap according to the
+	   configuration */
+{
+    struct param_t *poConf = &(poPlugin->oConf.oParam);
+    struct monitor_t *poMonitor = &(poPlugin->oMonitor);
+
+    if (poPlugin->poHeatmap)
+	HeatmapClose (poPlugin->poHeatmap);
+    g_free (poPlugin->poHeatmap);
+    poPlugin->poHeatmap = NULL;
+    if (*(poConf->acHeatmapDevices)) {
+	poPlugin->poHeatmap = g_new (heatmap_t, 1);
+	if (!HeatmapOpen (poPlugin->poHeatmap, poConf->acHeatmapDevices)) {
+	    g_free (poPlugin->poHeatmap);
+	    poPlugin->poHeatmap = NULL;
+	}
+    }
+    if (poPlugin->poHeatmap) {
+	gtk_widget_hide (poMonitor->awProgressBar[0]);
+	gtk_widget_hide (poMonitor->awProgressBar[1]);
+	gtk_widget_show (poMonitor->wHeatmap);
+    }
+    else {
+	gtk_widget_hide (poMonitor->wHeatmap);
+	gtk_widget_show (poMonitor->awProgressBar[0]);
+	if (!poConf->fRW_DataCombined)
+	    gtk_widget_show (poMonitor->awProgressBar[1]);
+    }
+    diskperf_set_size (poPlugin->plugin,
+		       xfce_panel_plugin_get_size (poPlugin->plugin),
+		       poPlugin);
+}				/* SetHeatmap() */
+
+	/**************************************************************/
+
 static void diskperf_construct (XfcePanelPlugin *plugin)
 {
     diskperf_t *diskperf = diskperf_create_control (plugin);
+    Widget_t    wMenuItem;
+
     xfce_textdomain(GETTEXT_PACKAGE, PACKAGE_LOCALE_DIR, "UTF-8");
 
     g_signal_connect (plugin, "free-data", G_CALLBACK (diskperf_free), 
@@ -1184,12 +2812,32 @@ static void diskperf_construct (XfcePanelPlugin *plugin)
     g_signal_connect (plugin, "configure-plugin", 
                       G_CALLBACK (diskperf_create_options), diskperf);
 
+    wMenuItem = gtk_menu_item_new_with_label (_("Disk I/O by process"));
+    gtk_widget_show (wMenuItem);
+    xfce_panel_plugin_menu_insert_item (plugin, GTK_MENU_ITEM (wMenuItem));
+    g_signal_connect (G_OBJECT (wMenuItem), "activate",
+                      G_CALLBACK (ShowProcView), diskperf);
+    wMenuItem = gtk_menu_item_new_with_label (_("Disk I/O details"));
+    gtk_widget_show (wMenuItem);
+    xfce_panel_plugin_menu_insert_item (plugin, GTK_MENU_ITEM (wMenuItem));
+    g_signal_connect (G_OBJECT (wMenuItem), "activate",
+                      G_CALLBACK (ShowDetailView), diskperf);
+    g_signal_connect (G_OBJECT (diskperf->oMonitor.wEventBox),
+                      "button-press-event",
+                      G_CALLBACK (ClickMonitor), diskperf);
+
     gtk_container_add (GTK_CONTAINER (plugin), diskperf->oMonitor.wEventBox);
 
     CreateMonitorBars (diskperf, xfce_panel_plugin_get_orientation (plugin));
     
     diskperf_read_config (plugin, diskperf);
     DevPerfInit();
+    SetExporter (diskperf);
+    SetCostAccounting (diskperf);
+    SetPressure (diskperf);
+    SetBatchedReads (diskperf);
+    SetHeatmap (diskperf);
+    SetSleepWatch (diskperf);
     
     DisplayPerf (diskperf);
     SetTimer (diskperf);
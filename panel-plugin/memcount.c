@@ -0,0 +1,86 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#include "memcount.h"
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+
+
+#if defined(__GLIBC__)
+	/**************************************************************/
+	/*************************	GNU libc	***************/
+	/**************************************************************/
+
+	/* The glibc allocator remains reachable through its __libc_*
+	   entry points, which lets the executable interpose the public
+	   ones */
+
+extern void    *__libc_malloc (size_t size);
+extern void    *__libc_calloc (size_t nmemb, size_t size);
+extern void    *__libc_realloc (void *ptr, size_t size);
+extern void     __libc_free (void *ptr);
+
+static volatile int64_t m_iAllocations = 0;
+
+
+void           *malloc (size_t size)
+{
+    m_iAllocations++;
+    return (__libc_malloc (size));
+}				/* malloc() */
+
+
+void           *calloc (size_t nmemb, size_t size)
+{
+    m_iAllocations++;
+    return (__libc_calloc (nmemb, size));
+}				/* calloc() */
+
+
+void           *realloc (void *ptr, size_t size)
+{
+    m_iAllocations++;
+    return (__libc_realloc (ptr, size));
+}				/* realloc() */
+
+
+void free (void *ptr)
+{
+    __libc_free (ptr);
+}				/* free() */
+
+
+int64_t MemCountAllocations (void)
+{
+    return (m_iAllocations);
+}				/* MemCountAllocations() */
+
+#else
+	/**************************************************************/
+	/********************	Unsupported platform	***************/
+	/**************************************************************/
+
+int64_t MemCountAllocations (void)
+{
+    return (-1);
+}				/* MemCountAllocations() */
+
+#endif
@@ -0,0 +1,44 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _memcount_h
+#define _memcount_h
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <inttypes.h>
+
+
+	/* Heap allocation counter.
+	   To be linked into standalone programs only (never into the panel
+	   plugin): it replaces malloc() and friends of the whole process. */
+
+
+#ifdef __cplusplus
+extern          "C" {
+#endif
+
+    int64_t         MemCountAllocations (void);
+    /* Return the number of heap allocations made so far by the
+       process, -1 if they cannot be counted on this platform */
+
+#ifdef __cplusplus
+}				/* extern "C" */
+#endif
+
+#endif				/* _memcount_h */
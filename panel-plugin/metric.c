@@ -0,0 +1,398 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+	/* Derived metric expressions: a recursive descent parser emits
+	   postfix code once, at configuration time, checking the stack
+	   depth it needs; evaluation is then a loop over that code */
+
+#include "metric.h"
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+
+enum {
+    /* Instructions */
+    OP_CONST,
+    OP_FIELD,			/* Value at the end of the interval */
+    OP_DELTA,			/* Change over the interval */
+    OP_DT,
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_NEG,
+    OP_MIN,
+    OP_MAX
+};
+
+enum {
+    /* Fields */
+    F_RBYTES,
+    F_WBYTES,
+    F_RIOS,
+    F_WIOS,
+    F_QLEN,
+    F_RBUSY,
+    F_WBUSY,
+    NFIELDS
+};
+
+static const char *const m_apcField[NFIELDS] = {
+    "rbytes", "wbytes", "rios", "wios", "qlen", "rbusy", "wbusy"
+};
+
+typedef struct parser_t {
+    const char     *pcStart;
+    const char     *pc;		/* Next character */
+    struct metric_t *poMetric;
+    int             iDepth;	/* Stack depth after the code so far */
+    int             iNesting;	/* Recursion depth of the parser */
+    char           *pcError;
+    size_t          iErrorSize;
+    int             fFailed;
+} parser_t;
+
+	/**************************************************************/
+
+static void Fail (struct parser_t *p_poParser, const char *p_pcWhat)
+{
+    if (!p_poParser->fFailed)
+	snprintf (p_poParser->pcError, p_poParser->iErrorSize,
+		  "%s at column %d", p_pcWhat,
+		  (int) (p_poParser->pc - p_poParser->pcStart) + 1);
+    p_poParser->fFailed = 1;
+}				/* Fail() */
+
+
+static void Emit (struct parser_t *p_poParser, int p_iCode, int p_iArg,
+		  int p_iDepthChange)
+{
+    struct metric_t *poMetric = p_poParser->poMetric;
+
+    if (p_poParser->fFailed)
+	return;
+    if (poMetric->n == METRIC_MAX_OPS) {
+	Fail (p_poParser, "Expression too long");
+	return;
+    }
+    p_poParser->iDepth += p_iDepthChange;
+    if (p_poParser->iDepth > METRIC_STACK) {
+	Fail (p_poParser, "Expression too deeply nested");
+	return;
+    }
+    poMetric->aoOp[poMetric->n].iCode = p_iCode;
+    poMetric->aoOp[poMetric->n].iArg = p_iArg;
+    poMetric->n++;
+}				/* Emit() */
+
+
+static int Accept (struct parser_t *p_poParser, char p_c)
+	/* Skip the next character if it is p_c */
+{
+    while (isspace ((unsigned char) *(p_poParser->pc)))
+	p_poParser->pc++;
+    if (*(p_poParser->pc) != p_c)
+	return (0);
+    p_poParser->pc++;
+    return (1);
+}				/* Accept() */
+
+
+static void Expect (struct parser_t *p_poParser, char p_c)
+{
+    static char     acWhat[] = "Expected '?'";
+
+    if (!Accept (p_poParser, p_c)) {
+	acWhat[sizeof (acWhat) - 3] = p_c;
+	Fail (p_poParser, acWhat);
+    }
+}				/* Expect() */
+
+
+static int Name (struct parser_t *p_poParser, char *p_acName, size_t p_iSize)
+	/* Read an identifier */
+	/* Return its length, 0 if there is none */
+{
+    size_t          n = 0;
+
+    while (isspace ((unsigned char) *(p_poParser->pc)))
+	p_poParser->pc++;
+    while ((isalnum ((unsigned char) p_poParser->pc[n])
+	    || (p_poParser->pc[n] == '_')) && (n < p_iSize - 1)) {
+	p_acName[n] = p_poParser->pc[n];
+	n++;
+    }
+    p_acName[n] = 0;
+    p_poParser->pc += n;
+    return ((int) n);
+}				/* Name() */
+
+
+static int Field (struct parser_t *p_poParser)
+	/* Return the field named next, -1 if none */
+{
+    const char     *pcName;
+    char            acName[16];
+    int             i;
+
+    while (isspace ((unsigned char) *(p_poParser->pc)))
+	p_poParser->pc++;
+    pcName = p_poParser->pc;
+    Name (p_poParser, acName, sizeof (acName));
+    for (i = 0; i < NFIELDS; i++)
+	if (!strcmp (acName, m_apcField[i]))
+	    return (i);
+    p_poParser->pc = pcName;
+    Fail (p_poParser, "Unknown field");
+    return (-1);
+}				/* Field() */
+
+static void Expression (struct parser_t *p_poParser);
+
+static void Primary (struct parser_t *p_poParser)
+{
+    struct metric_t *poMetric = p_poParser->poMetric;
+    const char     *pcName;
+    char            acName[16], *pcEnd;
+    double          r;
+    int             i;
+
+    if (Accept (p_poParser, '(')) {
+	Expression (p_poParser);
+	Expect (p_poParser, ')');
+	return;
+    }
+    r = strtod (p_poParser->pc, &pcEnd);
+    if (pcEnd != p_poParser->pc) {
+	p_poParser->pc = pcEnd;
+	if (poMetric->n < METRIC_MAX_OPS)
+	    poMetric->arConst[poMetric->n] = r;
+	Emit (p_poParser, OP_CONST, poMetric->n, 1);
+	return;
+    }
+    pcName = p_poParser->pc;
+    if (!Name (p_poParser, acName, sizeof (acName))) {
+	Fail (p_poParser, "Expected a value");
+	return;
+    }
+    if (!strcmp (acName, "dt"))
+	Emit (p_poParser, OP_DT, 0, 1);
+    else if (!strcmp (acName, "d")) {
+	Expect (p_poParser, '(');
+	i = Field (p_poParser);
+	Expect (p_poParser, ')');
+	Emit (p_poParser, OP_DELTA, i, 1);
+    }
+    else if (!strcmp (acName, "min") || !strcmp (acName, "max")) {
+	i = strcmp (acName, "min") ? OP_MAX : OP_MIN;
+	Expect (p_poParser, '(');
+	Expression (p_poParser);
+	Expect (p_poParser, ',');
+	Expression (p_poParser);
+	Expect (p_poParser, ')');
+	Emit (p_poParser, i, 0, -1);
+    }
+    else {
+	p_poParser->pc = pcName;
+	i = Field (p_poParser);
+	Emit (p_poParser, OP_FIELD, i, 1);
+    }
+}				/* Primary() */
+
+
+static void Unary (struct parser_t *p_poParser)
+{
+    if (++(p_poParser->iNesting) > METRIC_MAX_OPS)
+	Fail (p_poParser, "Expression too deeply nested");
+    else if (Accept (p_poParser, '-')) {
+	Unary (p_poParser);
+	Emit (p_poParser, OP_NEG, 0, 0);
+    }
+    else
+	Primary (p_poParser);
+    p_poParser->iNesting--;
+}				/* Unary() */
+
+
+static void Term (struct parser_t *p_poParser)
+{
+    Unary (p_poParser);
+    while (!p_poParser->fFailed)
+	if (Accept (p_poParser, '*')) {
+	    Unary (p_poParser);
+	    Emit (p_poParser, OP_MUL, 0, -1);
+	}
+	else if (Accept (p_poParser, '/')) {
+	    Unary (p_poParser);
+	    Emit (p_poParser, OP_DIV, 0, -1);
+	}
+	else
+	    break;
+}				/* Term() */
+
+
+static void Expression (struct parser_t *p_poParser)
+{
+    Term (p_poParser);
+    while (!p_poParser->fFailed)
+	if (Accept (p_poParser, '+')) {
+	    Term (p_poParser);
+	    Emit (p_poParser, OP_ADD, 0, -1);
+	}
+	else if (Accept (p_poParser, '-')) {
+	    Term (p_poParser);
+	    Emit (p_poParser, OP_SUB, 0, -1);
+	}
+	else
+	    break;
+}				/* Expression() */
+
+
+int MetricCompile (struct metric_t *p_poMetric, const char *p_pcExpression,
+		   char *p_pcError, size_t p_iErrorSize)
+{
+    struct parser_t oParser;
+
+    memset (p_poMetric, 0, sizeof (*p_poMetric));
+    memset (&oParser, 0, sizeof (oParser));
+    oParser.pcStart = oParser.pc = p_pcExpression;
+    oParser.poMetric = p_poMetric;
+    oParser.pcError = p_pcError;
+    oParser.iErrorSize = p_iErrorSize;
+    Expression (&oParser);
+    if (!Accept (&oParser, 0))
+	Fail (&oParser, "Unexpected character");
+    if (oParser.fFailed) {
+	p_poMetric->n = 0;
+	return (-1);
+    }
+    return (0);
+}				/* MetricCompile() */
+
+	/**************************************************************/
+
+static double FieldValue (const struct devperf_t *p_poPerf, int p_iField)
+{
+    switch (p_iField) {
+	case F_RBYTES:
+	    return (p_poPerf->rbytes);
+	case F_WBYTES:
+	    return (p_poPerf->wbytes);
+	case F_RIOS:
+	    return (p_poPerf->rios);
+	case F_WIOS:
+	    return (p_poPerf->wios);
+	case F_QLEN:
+	    return (p_poPerf->qlen);
+	case F_RBUSY:
+	    return (p_poPerf->rbusy_ns / 1e9);
+	case F_WBUSY:
+	default:
+	    return (p_poPerf->wbusy_ns / 1e9);
+    }
+}				/* FieldValue() */
+
+
+static double Delta (const struct devperf_t *p_poPrevPerf,
+		     const struct devperf_t *p_poPerf, int p_iField)
+	/* Differences of the integers, exact whatever their magnitude, and
+	   negative if a counter went backwards */
+{
+    switch (p_iField) {
+	case F_RBYTES:
+	    return ((int64_t) (p_poPerf->rbytes - p_poPrevPerf->rbytes));
+	case F_WBYTES:
+	    return ((int64_t) (p_poPerf->wbytes - p_poPrevPerf->wbytes));
+	case F_RIOS:
+	    return ((int64_t) (p_poPerf->rios - p_poPrevPerf->rios));
+	case F_WIOS:
+	    return ((int64_t) (p_poPerf->wios - p_poPrevPerf->wios));
+	case F_QLEN:
+	    return (p_poPerf->qlen - p_poPrevPerf->qlen);
+	case F_RBUSY:
+	    return ((int64_t) (p_poPerf->rbusy_ns - p_poPrevPerf->rbusy_ns) / 1e9);
+	case F_WBUSY:
+	default:
+	    return ((int64_t) (p_poPerf->wbusy_ns - p_poPrevPerf->wbusy_ns) / 1e9);
+    }
+}				/* Delta() */
+
+
+double MetricEval (const struct metric_t *p_poMetric,
+		   const struct devperf_t *p_poPrevPerf,
+		   const struct devperf_t *p_poPerf)
+{
+    const struct metric_op_t *poOp = p_poMetric->aoOp,
+	*poEnd = p_poMetric->aoOp + p_poMetric->n;
+    double          arStack[METRIC_STACK + 1], *pr = arStack;
+    /* *pr is the top of the stack, arStack[0] is never used */
+
+    arStack[1] = 0;
+    for (; poOp < poEnd; poOp++)
+	switch (poOp->iCode) {
+	    case OP_CONST:
+		*++pr = p_poMetric->arConst[poOp->iArg];
+		break;
+	    case OP_FIELD:
+		*++pr = FieldValue (p_poPerf, poOp->iArg);
+		break;
+	    case OP_DELTA:
+		*++pr = Delta (p_poPrevPerf, p_poPerf, poOp->iArg);
+		break;
+	    case OP_DT:
+		*++pr = (int64_t) (p_poPerf->timestamp_ns -
+				   p_poPrevPerf->timestamp_ns) / 1e9;
+		break;
+	    case OP_ADD:
+		pr--;
+		*pr += pr[1];
+		break;
+	    case OP_SUB:
+		pr--;
+		*pr -= pr[1];
+		break;
+	    case OP_MUL:
+		pr--;
+		*pr *= pr[1];
+		break;
+	    case OP_DIV:
+		pr--;
+		*pr = pr[1] ? *pr / pr[1] : 0;
+		break;
+	    case OP_NEG:
+		*pr = -*pr;
+		break;
+	    case OP_MIN:
+		pr--;
+		if (pr[1] < *pr)
+		    *pr = pr[1];
+		break;
+	    case OP_MAX:
+		pr--;
+		if (pr[1] > *pr)
+		    *pr = pr[1];
+		break;
+	}
+    return (arStack[1]);
+}				/* MetricEval() */
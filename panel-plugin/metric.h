@@ -0,0 +1,80 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef _metric_h
+#define _metric_h
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <inttypes.h>
+
+#include "devperf.h"
+
+
+#define METRIC_MAX_OPS	64	/* Instructions of a compiled expression */
+#define METRIC_STACK	16	/* Evaluation stack depth */
+
+ /* Derived metric expressions, over an interval between two samples:
+    expr    := term { ('+' | '-') term }
+    term    := unary { ('*' | '/') unary }
+    unary   := '-' unary | primary
+    primary := number | field | 'd' '(' field ')' | 'dt'
+	       | ('min' | 'max') '(' expr ',' expr ')' | '(' expr ')'
+    field   := 'rbytes' | 'wbytes' | 'rios' | 'wios' | 'qlen'
+	       | 'rbusy' | 'wbusy'	(seconds)
+    A field is its value at the end of the interval, d(field) its
+    change over the interval, dt the interval in seconds. Dividing by
+    0 gives 0. */
+
+typedef struct metric_op_t {
+    uint8_t         iCode;
+    uint8_t         iArg;	/* Field, or index of arConst[] */
+} metric_op_t;
+
+typedef struct metric_t {
+    /* Compiled expression: postfix code for a fixed-size stack */
+    int             n;		/* Instructions, 0 if none */
+    struct metric_op_t
+                    aoOp[METRIC_MAX_OPS];
+    double          arConst[METRIC_MAX_OPS];
+} metric_t;
+
+
+#ifdef __cplusplus
+extern          "C" {
+#endif
+
+    int             MetricCompile (struct metric_t *metric,
+				   const char *expression,
+				   char *error, size_t ErrorSize);
+    /* Parse expression into metric - On error, describe it into
+       error[ErrorSize], and leave metric empty */
+    /* Return 0 on success, -1 on error */
+
+    double          MetricEval (const struct metric_t *metric,
+				const struct devperf_t *PrevPerf,
+				const struct devperf_t *perf);
+    /* Evaluate metric over the interval from PrevPerf to perf - No
+       parsing, no allocation */
+
+#ifdef __cplusplus
+}				/* extern "C" */
+#endif
+
+#endif				/* _metric_h */
@@ -0,0 +1,207 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+	/* Mount point to block device resolution */
+
+#include "mountdev.h"
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+
+#if defined(__linux__)
+	/**************************************************************/
+	/**************************	Linux	***********************/
+	/**************************************************************/
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <unistd.h>
+#ifdef HAVE_SYS_SYSMACROS_H
+#include <sys/sysmacros.h>
+#endif
+
+#define MOUNTINFO	"/proc/self/mountinfo"
+
+
+static char    *ReadMountInfo (void)
+	/* Whole content, null-terminated - To be freed by the caller */
+{
+    char           *pcBuffer = 0, *pc;
+    size_t          iSize = 16384, n = 0;
+    ssize_t         iRead;
+    int             fd;
+
+    if ((fd = open (MOUNTINFO, O_RDONLY | O_CLOEXEC)) == -1)
+	return (0);
+    for (;;) {
+	if (!(pc = realloc (pcBuffer, iSize))) {
+	    free (pcBuffer);
+	    pcBuffer = 0;
+	    break;
+	}
+	pcBuffer = pc;
+	iRead = read (fd, pcBuffer + n, iSize - n - 1);
+	if (iRead <= 0) {
+	    pcBuffer[n] = 0;
+	    break;
+	}
+	n += iRead;
+	if (n + 1 == iSize)
+	    iSize *= 2;
+    }
+    close (fd);
+    return (pcBuffer);
+}				/* ReadMountInfo() */
+
+
+static void Unescape (char *p_pc)
+	/* mountinfo escapes blanks and backslashes as \ooo */
+{
+    char           *pcOut = p_pc;
+
+    for (; *p_pc; p_pc++, pcOut++) {
+	if ((p_pc[0] == '\\') && p_pc[1] && p_pc[2] && p_pc[3]) {
+	    *pcOut = (char) (((p_pc[1] - '0') << 6) | ((p_pc[2] - '0') << 3) |
+			     (p_pc[3] - '0'));
+	    p_pc += 3;
+	}
+	else
+	    *pcOut = *p_pc;
+    }
+    *pcOut = 0;
+}				/* Unescape() */
+
+
+static int SourceDevice (const char *p_pcSource, dev_t *p_piDev)
+{
+    struct stat     oStat;
+
+    if ((stat (p_pcSource, &oStat) == -1) || !S_ISBLK (oStat.st_mode))
+	return (-1);
+    *p_piDev = oStat.st_rdev;
+    return (0);
+}				/* SourceDevice() */
+
+
+static int LookupMount (const char *p_pcPath, dev_t p_iFsDev,
+			dev_t *p_piDev)
+	/* "36 35 0:32 /subvol /home rw,relatime shared:1 - btrfs /dev/sda2 rw"
+	   Prefer the mount whose MAJ:MIN is the file system of path, else
+	   the longest mount point holding path (a btrfs subvolume that is
+	   not mounted has a device number of its own) */
+{
+    char           *pcInfo, *pcLine, *pcNext, *pcMountPoint, *pcSource,
+	*pcSave, *pc;
+    char            acBestSource[PATH_MAX];
+    unsigned int    iMajor, iMinor;
+    size_t          iLength, iBest = 0;
+    int             fMatch = 0;
+
+    if (!(pcInfo = ReadMountInfo ()))
+	return (-1);
+    *acBestSource = 0;
+    for (pcLine = pcInfo; pcLine && *pcLine && !fMatch; pcLine = pcNext) {
+	if ((pcNext = strchr (pcLine, '\n')))
+	    *pcNext++ = 0;
+	if (sscanf (pcLine, "%*u %*u %u:%u", &iMajor, &iMinor) != 2)
+	    continue;
+	if (!(pc = strstr (pcLine, " - ")))
+	    continue;
+	strtok_r (pc + 3, " ", &pcSave);	/* File system type */
+	if (!(pcSource = strtok_r (0, " ", &pcSave)))
+	    continue;
+	strtok_r (pcLine, " ", &pcSave);	/* Mount ID */
+	strtok_r (0, " ", &pcSave);	/* Parent ID */
+	strtok_r (0, " ", &pcSave);	/* MAJ:MIN */
+	strtok_r (0, " ", &pcSave);	/* Root */
+	if (!(pcMountPoint = strtok_r (0, " ", &pcSave)))
+	    continue;
+	Unescape (pcSource);
+	Unescape (pcMountPoint);
+	if (makedev (iMajor, iMinor) == p_iFsDev)
+	    fMatch = 1;
+	else {
+	    iLength = strlen (pcMountPoint);
+	    if (strncmp (p_pcPath, pcMountPoint, iLength)
+		|| ((p_pcPath[iLength] != '/') && p_pcPath[iLength]
+		    && (iLength > 1)) || (iLength < iBest))
+		continue;
+	    iBest = iLength;
+	}
+	strncpy (acBestSource, pcSource, sizeof (acBestSource) - 1);
+	acBestSource[sizeof (acBestSource) - 1] = 0;
+    }
+    free (pcInfo);
+    return (*acBestSource ? SourceDevice (acBestSource, p_piDev) : -1);
+}				/* LookupMount() */
+
+
+int MountDevResolve (const char *p_pcPath, dev_t *p_piDev)
+{
+    char            acPath[PATH_MAX];
+    struct stat     oStat;
+
+    if (stat (p_pcPath, &oStat) == -1)
+	return (-1);
+    if (S_ISBLK (oStat.st_mode)) {
+	*p_piDev = oStat.st_rdev;
+	return (0);
+    }
+    if (major (oStat.st_dev)) {
+	*p_piDev = oStat.st_dev;
+	return (0);
+    }
+    if (!realpath (p_pcPath, acPath))
+	return (-1);
+    return (LookupMount (acPath, oStat.st_dev, p_piDev));
+}				/* MountDevResolve() */
+
+
+int MountDevWatch (void)
+{
+    return (open (MOUNTINFO, O_RDONLY | O_CLOEXEC));
+}				/* MountDevWatch() */
+
+#else
+	/**************************************************************/
+	/********************	Unsupported platform	***************/
+	/**************************************************************/
+
+int MountDevResolve (const char *p_pcPath, dev_t *p_piDev)
+{
+    struct stat     oStat;
+
+    if ((stat (p_pcPath, &oStat) == -1) || !S_ISBLK (oStat.st_mode))
+	return (-1);
+    *p_piDev = oStat.st_rdev;
+    return (0);
+}				/* MountDevResolve() */
+
+
+int MountDevWatch (void)
+{
+    return (-1);
+}				/* MountDevWatch() */
+
+#endif
@@ -0,0 +1,48 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _mountdev_h
+#define _mountdev_h
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <sys/types.h>
+
+
+#ifdef __cplusplus
+extern          "C" {
+#endif
+
+    int             MountDevResolve (const char *path, dev_t *dev);
+    /* Get the block device path lives on: path itself if it is a block
+       device, else the device of the file system holding it - a bind
+       mount resolves to its file system, a dm or md volume to itself.
+       File systems without a device number of their own (e.g. btrfs)
+       are looked up by their mount source in /proc/self/mountinfo */
+    /* Return 0 on success, -1 otherwise */
+
+    int             MountDevWatch (void);
+    /* Open a descriptor that poll() reports with POLLPRI whenever the
+       mount table changes - To be closed by the caller */
+    /* Return the descriptor, -1 on error */
+
+#ifdef __cplusplus
+}				/* extern "C" */
+#endif
+
+#endif				/* _mountdev_h */
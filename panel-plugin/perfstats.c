@@ -0,0 +1,317 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+	/* Statistics engine - Toolkit independent, shared by the panel
+	   plugin and diskperf-cli */
+
+#include "perfstats.h"
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#define SPLIT_DECAY	0.99	/* Weight of the past intervals in the
+				   busy time fit */
+#define SPLIT_SATURATED	99	/* Busy %: the device costs do not add
+				   up any longer */
+
+
+int PerfStatsContinuity (const struct devperf_t *p_poPrevPerf,
+			 const struct devperf_t *p_poPerf)
+{
+    if ((p_poPerf->timestamp_ns <= p_poPrevPerf->timestamp_ns)
+	|| (p_poPerf->rbytes < p_poPrevPerf->rbytes)
+	|| (p_poPerf->wbytes < p_poPrevPerf->wbytes)
+	|| (p_poPerf->rbusy_ns < p_poPrevPerf->rbusy_ns)
+	|| (p_poPerf->wbusy_ns < p_poPrevPerf->wbusy_ns)
+	|| (p_poPerf->rios < p_poPrevPerf->rios)
+	|| (p_poPerf->wios < p_poPrevPerf->wios))
+	return (PERF_REGRESSED);
+    if (p_poPerf->timestamp_ns - p_poPrevPerf->timestamp_ns >
+	PERFSTATS_MAX_INTERVAL_NS)
+	return (PERF_GAP);
+    return (PERF_CONTINUOUS);
+}				/* PerfStatsContinuity() */
+
+
+int PerfStatsUpdate (struct devperf_t *p_poPrevPerf,
+		     const struct devperf_t *p_poPerf,
+		     struct perfstats_t *p_poStats)
+{
+    uint64_t        iInterval_ns, rbytes, wbytes, iRBusy_ns, iWBusy_ns,
+	rios, wios;
+    const double    K = 1.0 * 1000 * 1000 * 1000 / 1024 / 1024;
+    /* bytes/ns --> MB/s */
+    double         *pr;
+    int             i, status = 1;
+
+    rbytes = wbytes = iRBusy_ns = iWBusy_ns = rios = wios = -1;
+    iInterval_ns = 0;
+    if (p_poPrevPerf->timestamp_ns
+	&& PerfStatsContinuity (p_poPrevPerf, p_poPerf))
+	status = 2;		/* Only a new baseline */
+    else if (p_poPrevPerf->timestamp_ns) {
+	iInterval_ns = p_poPerf->timestamp_ns - p_poPrevPerf->timestamp_ns;
+	rbytes = p_poPerf->rbytes - p_poPrevPerf->rbytes;
+	wbytes = p_poPerf->wbytes - p_poPrevPerf->wbytes;
+	iRBusy_ns = p_poPerf->rbusy_ns - p_poPrevPerf->rbusy_ns;
+	iWBusy_ns = p_poPerf->wbusy_ns - p_poPrevPerf->wbusy_ns;
+	rios = p_poPerf->rios - p_poPrevPerf->rios;
+	wios = p_poPerf->wios - p_poPrevPerf->wios;
+    }
+    *p_poPrevPerf = *p_poPerf;
+    p_poStats->iInterval_ns = iInterval_ns;
+    p_poStats->qlen = p_poPerf->qlen;
+    p_poStats->fBusyValid = (p_poPerf->qlen >= 0);
+    p_poStats->fBusyEstimated = 0;
+    if (!iInterval_ns)
+	return (status);
+
+    p_poStats->arPerf[R_DATA] = K * rbytes / iInterval_ns;
+    p_poStats->arPerf[W_DATA] = K * wbytes / iInterval_ns;
+    p_poStats->arPerf[RW_DATA] = K * (rbytes + wbytes) / iInterval_ns;
+
+    p_poStats->arIops[R_DATA] = 1e9 * rios / iInterval_ns;
+    p_poStats->arIops[W_DATA] = 1e9 * wios / iInterval_ns;
+    p_poStats->arIops[RW_DATA] = 1e9 * (rios + wios) / iInterval_ns;
+    /* Linux accounts the time of every request, so that this is the
+       average wait + service time; elsewhere it is the service time */
+    p_poStats->rAwait_ms = (p_poStats->fBusyValid && (rios + wios)) ?
+	(iRBusy_ns + iWBusy_ns) / 1e6 / (rios + wios) : 0;
+
+    if (!p_poStats->fBusyValid)
+	for (i = 0; i < NMONITORS; i++)
+	    p_poStats->arBusy[i] = 0;
+    else {
+	p_poStats->arBusy[R_DATA] = (double) 100.0 *iRBusy_ns / iInterval_ns;
+	p_poStats->arBusy[W_DATA] = (double) 100.0 *iWBusy_ns / iInterval_ns;
+	p_poStats->arBusy[RW_DATA] =
+	    (double) 100.0 *(iRBusy_ns + iWBusy_ns) / iInterval_ns;
+	for (i = 0; i < NMONITORS; i++) {
+	    pr = p_poStats->arBusy + i;
+	    if (*pr > 100)
+		*pr = 100;
+	}
+#if !SEPARATE_BUSY_TIMES
+	PerfStatsSplitBusy (NULL, p_poStats);	/* Not 50/50 at least */
+#endif
+    }
+    return (0);
+}				/* PerfStatsUpdate() */
+
+
+void PerfStatsSplitBusy (struct busysplit_t *p_poFit,
+			 struct perfstats_t *p_poStats)
+	/* A request costs a time per operation plus a time per byte.
+	   The fit learns both from the intervals with a varying mix; until
+	   it can tell them apart, the read share is half that of the
+	   operations plus half that of the bytes, which is exact when
+	   the device only reads or only writes. */
+{
+    const double   *arIops = p_poStats->arIops, *arPerf = p_poStats->arPerf;
+    double          rBusy = p_poStats->arBusy[RW_DATA], rDet, a = -1,
+	b = -1, rRead, rWrite, rShare = 0, rWeight = 0;
+
+    if (p_poFit && (rBusy < SPLIT_SATURATED)) {
+	p_poFit->rSii = SPLIT_DECAY * p_poFit->rSii +
+	    arIops[RW_DATA] * arIops[RW_DATA];
+	p_poFit->rSib = SPLIT_DECAY * p_poFit->rSib +
+	    arIops[RW_DATA] * arPerf[RW_DATA];
+	p_poFit->rSbb = SPLIT_DECAY * p_poFit->rSbb +
+	    arPerf[RW_DATA] * arPerf[RW_DATA];
+	p_poFit->rSiy = SPLIT_DECAY * p_poFit->rSiy + arIops[RW_DATA] * rBusy;
+	p_poFit->rSby = SPLIT_DECAY * p_poFit->rSby + arPerf[RW_DATA] * rBusy;
+    }
+    if (p_poFit) {
+	/* Solve, unless the mix never varied (collinear sums) */
+	rDet = p_poFit->rSii * p_poFit->rSbb - p_poFit->rSib * p_poFit->rSib;
+	if (rDet > 1e-3 * p_poFit->rSii * p_poFit->rSbb) {
+	    a = (p_poFit->rSiy * p_poFit->rSbb -
+		 p_poFit->rSby * p_poFit->rSib) / rDet;
+	    b = (p_poFit->rSby * p_poFit->rSii -
+		 p_poFit->rSiy * p_poFit->rSib) / rDet;
+	    if ((a < 0) && p_poFit->rSbb > 0) {	/* Time per byte only */
+		a = 0;
+		b = p_poFit->rSby / p_poFit->rSbb;
+	    }
+	    else if ((b < 0) && p_poFit->rSii > 0) {	/* Per operation */
+		a = p_poFit->rSiy / p_poFit->rSii;
+		b = 0;
+	    }
+	}
+    }
+    rRead = a * arIops[R_DATA] + b * arPerf[R_DATA];
+    rWrite = a * arIops[W_DATA] + b * arPerf[W_DATA];
+    if ((a >= 0) && (b >= 0) && (rRead + rWrite > 0))
+	rShare = rRead / (rRead + rWrite);
+    else {
+	if (arIops[RW_DATA] > 0) {
+	    rShare += arIops[R_DATA] / arIops[RW_DATA];
+	    rWeight++;
+	}
+	if (arPerf[RW_DATA] > 0) {
+	    rShare += arPerf[R_DATA] / arPerf[RW_DATA];
+	    rWeight++;
+	}
+	rShare = rWeight ? rShare / rWeight : 0.5;
+    }
+    p_poStats->arBusy[R_DATA] = rShare * rBusy;
+    p_poStats->arBusy[W_DATA] = rBusy - p_poStats->arBusy[R_DATA];
+    p_poStats->fBusyEstimated = 1;
+}				/* PerfStatsSplitBusy() */
+
+
+void PerfStatsFractions (const struct perfstats_t *p_poStats,
+			 enum statistics_t p_eStatistics,
+			 int p_iMaxXferMBperSec, double *p_prFractions)
+{
+    double         *pr;
+    int             i;
+
+    switch (p_eStatistics) {
+	case BUSY_TIME:
+	    for (i = 0; i < NMONITORS; i++)
+		p_prFractions[i] = p_poStats->arBusy[i] / 100;
+	    break;
+	case IO_TRANSFER:
+	default:
+	    for (i = 0; i < NMONITORS; i++)
+		p_prFractions[i] =
+		    p_poStats->arPerf[i] / p_iMaxXferMBperSec;
+	    break;
+    }
+    for (i = 0; i < NMONITORS; i++) {
+	pr = p_prFractions + i;
+	if (*pr > 1)
+	    *pr = 1;
+	else if (*pr < 0)
+	    *pr = 0;
+    }
+}				/* PerfStatsFractions() */
+
+	/**************************************************************/
+
+	/* Batch of devices: the counters are narrowed to 32 bits, in units
+	   of 4 KiB (transfers) or 1.024 us (busy times), which wrap far
+	   beyond any update period. A fraction is then (d >> k) * scale
+	   >> 16, where d is the counter delta clamped to the full scale of
+	   the interval, k brings the full scale below 2^16 and scale is
+	   the rounded 2^31 / (full scale >> k): at least 2^15, so that the
+	   fraction is within 2^-14 of the exact one, and everything fits
+	   in 32-bit integers: no division, no floating point and no branch
+	   per device, and the compiler turns the loop into vector code. */
+
+#define BYTES_SHIFT	12
+#define BUSY_SHIFT	10
+#define FULL_SCALE_MAX	((uint32_t) 1 << 31)
+#define BATCH_BLOCK	16	/* Devices per iteration */
+
+void PerfBatchInit (struct perfbatch_t *p_poBatch, int p_n)
+{
+    memset (p_poBatch, 0, sizeof (*p_poBatch));
+    p_poBatch->n = (p_n > PERFBATCH_MAX) ? PERFBATCH_MAX : p_n;
+}				/* PerfBatchInit() */
+
+
+static void BatchFractions (int p_n, const uint32_t *restrict p_aiCur,
+			    const uint32_t *restrict p_aiPrev,
+			    const uint32_t *restrict p_aiMask,
+			    uint32_t p_iFull, uint32_t p_iShift,
+			    uint32_t p_iScale, int32_t *restrict p_aiFraction)
+	/* The vectorised loop - Whole blocks of BATCH_BLOCK devices are
+	   processed (the arrays are sized accordingly), so that there is
+	   no scalar remainder and -O2 vectorises it as well as -O3 */
+{
+    uint32_t        d;
+    int             i, j;
+
+    for (i = 0; i < p_n; i += BATCH_BLOCK)
+	for (j = i; j < i + BATCH_BLOCK; j++) {
+	    d = p_aiCur[j] - p_aiPrev[j];
+	    d = ((d < p_iFull) ? d : p_iFull) >> p_iShift;
+	    p_aiFraction[j] =
+		(int32_t) (((d * p_iScale) >> 16) | ~p_aiMask[j]);
+	}
+}				/* BatchFractions() */
+
+
+int PerfBatchUpdate (struct perfbatch_t *p_poBatch,
+		     const struct devperf_t *p_aoPerf, const int *p_aiStatus,
+		     enum statistics_t p_eStatistics, int p_iMaxXferMBperSec)
+{
+    const int       n = p_poBatch->n;
+    uint64_t        iInterval_ns, iTimestamp_ns = 0;
+    double          rFull;
+    uint32_t        iFull, iShift, iMask;
+    int             i;
+
+    /* Gather the counters of the snapshot */
+    if (p_eStatistics == BUSY_TIME)
+	for (i = 0; i < n; i++)
+	    p_poBatch->aiCur[i] = (uint32_t)
+		((p_aoPerf[i].rbusy_ns + p_aoPerf[i].wbusy_ns) >> BUSY_SHIFT);
+    else
+	for (i = 0; i < n; i++)
+	    p_poBatch->aiCur[i] = (uint32_t)
+		((p_aoPerf[i].rbytes + p_aoPerf[i].wbytes) >> BYTES_SHIFT);
+    for (i = 0; i < n; i++) {
+	iMask = p_aiStatus[i] ? 0 : ~0u;
+	/* Counter reset: no fraction, the current one is the baseline */
+	p_poBatch->aiMask[i] = p_poBatch->aiPrevMask[i] & iMask
+	    & (((int32_t) (p_poBatch->aiCur[i] - p_poBatch->aiPrev[i]) < 0) ?
+	       0 : ~0u);
+	p_poBatch->aiPrevMask[i] = iMask;
+	if (!iTimestamp_ns && iMask)
+	    iTimestamp_ns = p_aoPerf[i].timestamp_ns;
+    }
+
+    iInterval_ns = (p_poBatch->iTimestamp_ns
+		    && (p_poBatch->eStatistics == p_eStatistics)
+		    && (iTimestamp_ns > p_poBatch->iTimestamp_ns)
+	    && (iTimestamp_ns - p_poBatch->iTimestamp_ns <=
+		PERFSTATS_MAX_INTERVAL_NS)) ?
+	iTimestamp_ns - p_poBatch->iTimestamp_ns : 0;
+    p_poBatch->iTimestamp_ns = iTimestamp_ns;
+    p_poBatch->eStatistics = p_eStatistics;
+    if (!iInterval_ns) {
+	memcpy (p_poBatch->aiPrev, p_poBatch->aiCur, n * sizeof (uint32_t));
+	for (i = 0; i < n; i++)
+	    p_poBatch->aiFraction[i] = -1;
+	return (1);
+    }
+
+    /* Full scale of the interval, in counter units */
+    if (p_eStatistics == BUSY_TIME)
+	rFull = (double) iInterval_ns / (1 << BUSY_SHIFT);
+    else
+	rFull = (double) p_iMaxXferMBperSec * 1024 * 1024 / 1e9
+	    * iInterval_ns / (1 << BYTES_SHIFT);
+    iFull = (rFull < 1) ? 1 :
+	(rFull > FULL_SCALE_MAX) ? FULL_SCALE_MAX : (uint32_t) rFull;
+    for (iShift = 0; (iFull >> iShift) >= (1u << 16); iShift++);
+    BatchFractions (n, p_poBatch->aiCur, p_poBatch->aiPrev,
+		    p_poBatch->aiMask, iFull, iShift,
+		    (FULL_SCALE_MAX + (iFull >> iShift) / 2) / (iFull >> iShift),
+		    p_poBatch->aiFraction);
+    memcpy (p_poBatch->aiPrev, p_poBatch->aiCur, n * sizeof (uint32_t));
+    return (0);
+}				/* PerfBatchUpdate() */
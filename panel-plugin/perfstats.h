@@ -0,0 +1,166 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _perfstats_h
+#define _perfstats_h
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+#include "devperf.h"
+
+
+ /* Some platforms do not provide busy times as separate read and write
+    data, but only a single value combining both */
+#if  defined(__NetBSD__)
+#define	SEPARATE_BUSY_TIMES	0
+#elif  defined(__sun__)
+#define	SEPARATE_BUSY_TIMES	0
+#elif defined(__linux__)
+#define	SEPARATE_BUSY_TIMES	1
+#else
+#define	SEPARATE_BUSY_TIMES	1
+#endif
+
+
+typedef enum statistics_t {
+    IO_TRANSFER,		/* MB transferred per second */
+    BUSY_TIME			/* Percentage of time the device has been
+				   busy */
+} statistics_t;
+
+#define PERFSTATS_MAX_INTERVAL_NS	(300ull * 1000 * 1000 * 1000)
+    /* Longer intervals are gaps (e.g. suspended system): not averaged */
+
+enum {
+    /* Continuity of two samples of a device */
+    PERF_CONTINUOUS,
+    PERF_REGRESSED,		/* A counter or the clock went backwards:
+				   counters reset, or device replaced */
+    PERF_GAP			/* Longer than PERFSTATS_MAX_INTERVAL_NS */
+};
+
+enum {
+    /* Monitor bar data */
+    R_DATA,
+    W_DATA,
+    RW_DATA,
+    NMONITORS
+};
+
+typedef struct perfstats_t {
+    /* Statistics computed between two consecutive samples */
+    uint64_t        iInterval_ns;
+    double          arPerf[NMONITORS];	/* I/O transfer rates (MiB/s) */
+    double          arBusy[NMONITORS];	/* Busy times (%) */
+    double          arIops[NMONITORS];	/* I/O operations per second */
+    double          rAwait_ms;	/* Average time per I/O, 0 if none */
+    int             fBusyValid;	/* Busy times provided by the kernel */
+    int             fBusyEstimated;	/* Only their total is: the read
+					   and write ones are estimates
+					   (PerfStatsSplitBusy()) */
+    int32_t         qlen;	/* Current queue length */
+} perfstats_t;
+
+typedef struct busysplit_t {
+    /* Least-squares fit of the busy time of a device as
+       a x I/O operations per second + b x MiB/s, over its past
+       intervals (exponentially forgotten) */
+    double          rSii, rSib, rSbb;	/* Sums of the products of the */
+    double          rSiy, rSby;	/* IOPS, MiB/s and busy % */
+} busysplit_t;
+
+#define PERFBATCH_MAX	1024	/* Devices */
+#define PERFBATCH_ONE	32768	/* Fraction 1, in fixed point */
+
+typedef struct perfbatch_t {
+    /* Devices collected together, kept as arrays indexed by device so
+       that their fractions are all computed by one vectorisable loop -
+       The counters are stored as 32-bit fixed-point units - Only the
+       read + write fraction is computed: the heatmap cells use it, the
+       monitor bars need the full statistics (DevStateUpdate()) */
+    int             n;
+    enum statistics_t
+                    eStatistics;	/* Of the units of aiPrev */
+    uint64_t        iTimestamp_ns;	/* Of aiPrev, 0 if none */
+    uint32_t        aiPrev[PERFBATCH_MAX];
+    uint32_t        aiCur[PERFBATCH_MAX];
+    uint32_t        aiPrevMask[PERFBATCH_MAX];	/* ~0 if aiPrev is valid */
+    uint32_t        aiMask[PERFBATCH_MAX];	/* ~0 if both are */
+    int32_t         aiFraction[PERFBATCH_MAX];
+    /* Read + write monitor bar fraction, in [0, PERFBATCH_ONE] - -1 if
+       unavailable */
+} perfbatch_t;
+
+
+#ifdef __cplusplus
+extern          "C" {
+#endif
+
+    int             PerfStatsContinuity (const struct devperf_t *PrevPerf,
+					 const struct devperf_t *perf);
+    /* Check that perf follows PrevPerf */
+    /* Return PERF_CONTINUOUS, PERF_REGRESSED or PERF_GAP */
+
+    int             PerfStatsUpdate (struct devperf_t *PrevPerf,
+				     const struct devperf_t *perf,
+				     struct perfstats_t *stats);
+    /* Compute the statistics between PrevPerf and perf, then store
+       perf into PrevPerf */
+    /* Return 0 on success, 1 if no interval is available yet, 2 if perf
+       does not follow PrevPerf (see PerfStatsContinuity()) and only
+       sets a new baseline */
+
+    void            PerfStatsSplitBusy (struct busysplit_t *fit,
+					struct perfstats_t *stats);
+    /* For platforms reporting only the total busy time: estimate its
+       read and write shares from the I/O operations and bytes of each
+       direction, learning the device costs into fit (NULL: none) */
+
+    void            PerfStatsFractions (const struct perfstats_t *stats,
+					enum statistics_t eStatistics,
+					int MaxXferMBperSec,
+					double *fractions);
+    /* Normalise the statistics into NMONITORS monitor bar fractions,
+       clamped to [0, 1] */
+
+    void            PerfBatchInit (struct perfbatch_t *batch, int n);
+    /* Initialize a batch of n devices, at most PERFBATCH_MAX */
+
+    int             PerfBatchUpdate (struct perfbatch_t *batch,
+				     const struct devperf_t *perf,
+				     const int *status,
+				     enum statistics_t eStatistics,
+				     int MaxXferMBperSec);
+    /* Compute the read + write fraction of every device from the
+       snapshot perf[] (DevGetPerfDataN() output, status[i] being the
+       result of device i), then keep it as the previous one - The
+       interval is the one of the first available device, all of them
+       having been read at once - A device whose counter went backwards
+       gets no fraction (-1) for the interval */
+    /* Return 0 on success, 1 if no interval is available yet (or it
+       was a gap) */
+
+#ifdef __cplusplus
+}				/* extern "C" */
+#endif
+
+#endif				/* _perfstats_h */
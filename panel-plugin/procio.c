@@ -0,0 +1,315 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+	/* Per-process I/O attribution, from /proc/<pid>/io */
+
+#include "procio.h"
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+
+#if defined(__linux__)
+	/**************************************************************/
+	/**************************	Linux	***********************/
+	/**************************************************************/
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <time.h>
+
+#define MIN_ENTRIES	256
+
+
+static uint64_t Now_ns (void)
+{
+    struct timespec oNow;
+
+    clock_gettime (CLOCK_MONOTONIC, &oNow);
+    return ((uint64_t) 1000 * 1000 * 1000 * oNow.tv_sec + oNow.tv_nsec);
+}				/* Now_ns() */
+
+
+static int ReadProcFile (int p_iProcFd, const char *p_pcPid,
+			 const char *p_pcFile, char *p_pcBuffer,
+			 size_t p_iSize)
+	/* Read a small /proc/<pid>/ file, relative to the cached /proc
+	   directory; the content is null-terminated */
+{
+    char            acPath[64];
+    ssize_t         n;
+    int             fd;
+
+    snprintf (acPath, sizeof (acPath), "%s/%s", p_pcPid, p_pcFile);
+    fd = openat (p_iProcFd, acPath, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+	return (-1);
+    n = read (fd, p_pcBuffer, p_iSize - 1);
+    close (fd);
+    if (n < 0)
+	return (-1);
+    p_pcBuffer[n] = 0;
+    return (n);
+}				/* ReadProcFile() */
+
+
+static uint64_t IoField (const char *p_pcBuffer, const char *p_pcName)
+	/* Value of one "name: value" line of /proc/<pid>/io */
+{
+    const char     *pc;
+    size_t          n = strlen (p_pcName);
+
+    for (pc = p_pcBuffer; pc; pc = strchr (pc, '\n')) {
+	if (*pc == '\n')
+	    pc++;
+	if (!strncmp (pc, p_pcName, n) && (pc[n] == ':'))
+	    return (strtoull (pc + n + 1, 0, 10));
+    }
+    return (0);
+}				/* IoField() */
+
+
+static int Grow (struct procio_t *p_poProcIo)
+{
+    struct procio_entry_t *poEntry, *poSpare;
+    size_t          iSize;
+
+    iSize = (p_poProcIo->iSize ? 2 * p_poProcIo->iSize : MIN_ENTRIES);
+    poEntry = realloc (p_poProcIo->aoEntry, iSize * sizeof (*poEntry));
+    if (!poEntry)
+	return (-1);
+    p_poProcIo->aoEntry = poEntry;
+    poSpare = realloc (p_poProcIo->aoSpare, iSize * sizeof (*poSpare));
+    if (!poSpare)
+	return (-1);
+    p_poProcIo->aoSpare = poSpare;
+    p_poProcIo->iSize = iSize;
+    return (0);
+}				/* Grow() */
+
+
+static const struct procio_entry_t *Find (const struct procio_t
+					  *p_poProcIo, pid_t p_pid)
+{
+    size_t          iLow = 0, iHigh = p_poProcIo->n, i;
+
+    while (iLow < iHigh) {
+	i = (iLow + iHigh) / 2;
+	if (p_poProcIo->aoEntry[i].pid < p_pid)
+	    iLow = i + 1;
+	else
+	    iHigh = i;
+    }
+    if ((iLow < p_poProcIo->n) && (p_poProcIo->aoEntry[iLow].pid == p_pid))
+	return (p_poProcIo->aoEntry + iLow);
+    return (0);
+}				/* Find() */
+
+
+int ProcIoOpen (struct procio_t *p_poProcIo)
+{
+    DIR            *poDir;
+
+    memset (p_poProcIo, 0, sizeof (*p_poProcIo));
+    p_poProcIo->iProcFd = -1;
+    if (!(poDir = opendir ("/proc")))
+	return (-1);
+    p_poProcIo->pvProcDir = poDir;
+    p_poProcIo->iProcFd = dirfd (poDir);
+    return (0);
+}				/* ProcIoOpen() */
+
+
+void ProcIoClose (struct procio_t *p_poProcIo)
+{
+    if (p_poProcIo->pvProcDir)
+	closedir ((DIR *) p_poProcIo->pvProcDir);
+    free (p_poProcIo->aoEntry);
+    free (p_poProcIo->aoSpare);
+    memset (p_poProcIo, 0, sizeof (*p_poProcIo));
+    p_poProcIo->iProcFd = -1;
+}				/* ProcIoClose() */
+
+
+int ProcIoScan (struct procio_t *p_poProcIo)
+	/* /proc lists the processes by increasing PID, so the new table is
+	   built by walking the previous one alongside: processes that
+	   vanished are skipped, known ones keep their baseline and name,
+	   and only the new ones need their comm file read. Reading an io
+	   file costs 3 system calls: the processes that were idle, or
+	   whose file we may not read, are only read one scan in
+	   PROCIO_IDLE_SLICES (by PID), so that a host with thousands of
+	   sleeping processes costs a fraction of that. Their I/O is not
+	   lost, only seen up to PROCIO_IDLE_SLICES scans late, and spread
+	   over the time since their previous read. */
+{
+    DIR            *poDir = (DIR *) p_poProcIo->pvProcDir;
+    struct dirent  *poEntry;
+    struct procio_entry_t *poNew, *poSwap;
+    const struct procio_entry_t *poOld;
+    char            acBuffer[512], *pc;
+    uint64_t        iNow_ns;
+    size_t          n = 0, iOld = 0;
+    pid_t           pid, iLastPid = 0;
+    uint32_t        iScan = p_poProcIo->iScan++;
+    int             nReadable = 0;
+
+    if (!poDir)
+	return (-1);
+    rewinddir (poDir);
+    iNow_ns = Now_ns ();
+    while ((poEntry = readdir (poDir))) {
+	if ((*poEntry->d_name < '1') || (*poEntry->d_name > '9'))
+	    continue;
+	pid = strtol (poEntry->d_name, &pc, 10);
+	if (*pc)
+	    continue;
+	if ((n == p_poProcIo->iSize) && (Grow (p_poProcIo) == -1))
+	    break;
+	if (pid > iLastPid) {
+	    while ((iOld < p_poProcIo->n)
+		   && (p_poProcIo->aoEntry[iOld].pid < pid))
+		iOld++;
+	    poOld = ((iOld < p_poProcIo->n)
+		     && (p_poProcIo->aoEntry[iOld].pid ==
+			 pid) ? p_poProcIo->aoEntry + iOld : 0);
+	}
+	else			/* Out of order: should not happen */
+	    poOld = Find (p_poProcIo, pid);
+	iLastPid = pid;
+
+	poNew = p_poProcIo->aoSpare + n;
+	if (poOld && !(poOld->drbytes + poOld->dwbytes)
+	    && ((pid + iScan) % PROCIO_IDLE_SLICES)) {
+	    /* Idle or unreadable, not its turn: keep its baseline */
+	    *poNew = *poOld;
+	    poNew->iInterval_ns = 0;
+	    nReadable += (poNew->iRead_ns != 0);
+	    n++;
+	    continue;
+	}
+	poNew->pid = pid;
+	if (ReadProcFile (p_poProcIo->iProcFd, poEntry->d_name, "io",
+			  acBuffer, sizeof (acBuffer)) <= 0) {
+	    /* Gone, or not ours to look at: try again in turn */
+	    memset (poNew, 0, sizeof (*poNew));
+	    poNew->pid = pid;
+	    n++;
+	    continue;
+	}
+	nReadable++;
+	poNew->rbytes = IoField (acBuffer, "read_bytes");
+	poNew->wbytes = IoField (acBuffer, "write_bytes");
+	poNew->iRead_ns = iNow_ns;
+	if (poOld && poOld->iRead_ns && (poNew->rbytes >= poOld->rbytes)
+	    && (poNew->wbytes >= poOld->wbytes)) {
+	    poNew->drbytes = poNew->rbytes - poOld->rbytes;
+	    poNew->dwbytes = poNew->wbytes - poOld->wbytes;
+	    poNew->iInterval_ns = iNow_ns - poOld->iRead_ns;
+	    memcpy (poNew->acComm, poOld->acComm, sizeof (poNew->acComm));
+	}
+	else {			/* New process (or PID reused) */
+	    poNew->drbytes = poNew->dwbytes = 0;
+	    poNew->iInterval_ns = 0;
+	    if (ReadProcFile (p_poProcIo->iProcFd, poEntry->d_name, "comm",
+			      acBuffer, sizeof (poNew->acComm) + 1) <= 0)
+		*acBuffer = 0;
+	    if ((pc = strchr (acBuffer, '\n')))
+		*pc = 0;
+	    memcpy (poNew->acComm, acBuffer, sizeof (poNew->acComm));
+	    poNew->acComm[sizeof (poNew->acComm) - 1] = 0;
+	}
+	n++;
+    }
+    poSwap = p_poProcIo->aoEntry;
+    p_poProcIo->aoEntry = p_poProcIo->aoSpare;
+    p_poProcIo->aoSpare = poSwap;
+    p_poProcIo->n = n;
+    p_poProcIo->iInterval_ns =
+	(p_poProcIo->iTimestamp_ns ? iNow_ns - p_poProcIo->iTimestamp_ns : 0);
+    p_poProcIo->iTimestamp_ns = iNow_ns;
+    return (nReadable);
+}				/* ProcIoScan() */
+
+#else
+	/**************************************************************/
+	/********************	Unsupported platform	***************/
+	/**************************************************************/
+
+int ProcIoOpen (struct procio_t *p_poProcIo)
+{
+    memset (p_poProcIo, 0, sizeof (*p_poProcIo));
+    p_poProcIo->iProcFd = -1;
+    return (-1);
+}				/* ProcIoOpen() */
+
+
+void ProcIoClose (struct procio_t *p_poProcIo)
+{
+}				/* ProcIoClose() */
+
+
+int ProcIoScan (struct procio_t *p_poProcIo)
+{
+    return (-1);
+}				/* ProcIoScan() */
+
+#endif
+
+
+static double Rate (const struct procio_entry_t *p_poEntry)
+	/* Bytes per ns over the last interval of the process */
+{
+    return ((double) (p_poEntry->drbytes + p_poEntry->dwbytes) /
+	    p_poEntry->iInterval_ns);
+}				/* Rate() */
+
+
+int ProcIoTop (const struct procio_t *p_poProcIo,
+	       const struct procio_entry_t **p_ppoTop, int p_n)
+	/* Partial insertion sort: p_n is a handful of lines */
+{
+    const struct procio_entry_t *poEntry;
+    double          rRate;
+    size_t          i;
+    int             n = 0, j;
+
+    for (i = 0; i < p_poProcIo->n; i++) {
+	poEntry = p_poProcIo->aoEntry + i;
+	if (!poEntry->iInterval_ns
+	    || !(poEntry->drbytes + poEntry->dwbytes))
+	    continue;
+	rRate = Rate (poEntry);
+	for (j = n; j > 0; j--) {
+	    if (Rate (p_ppoTop[j - 1]) >= rRate)
+		break;
+	    if (j < p_n)
+		p_ppoTop[j] = p_ppoTop[j - 1];
+	}
+	if (j < p_n) {
+	    p_ppoTop[j] = poEntry;
+	    if (n < p_n)
+		n++;
+	}
+    }
+    return (n);
+}				/* ProcIoTop() */
@@ -0,0 +1,92 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _procio_h
+#define _procio_h
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <sys/types.h>
+
+
+#define PROCIO_IDLE_SLICES	8
+/* Processes which did no I/O (or could not be read) at their last read
+   are read again one scan in PROCIO_IDLE_SLICES */
+
+typedef struct procio_entry_t {
+    /* I/O counters of a single process */
+    pid_t           pid;
+    uint64_t        rbytes;	/* Bytes read from storage so far */
+    uint64_t        wbytes;	/* Bytes written to storage so far */
+    uint64_t        drbytes;	/* Bytes read during the last interval */
+    uint64_t        dwbytes;	/* Bytes written during the last interval */
+    uint64_t        iInterval_ns;	/* Length of that interval, 0 if none
+					   (it spans the scans that skipped
+					   the process) */
+    uint64_t        iRead_ns;	/* Time of the last read, 0 if /proc/<pid>/io
+				   is not ours to read */
+    char            acComm[16];	/* Command name */
+} procio_entry_t;
+
+typedef struct procio_t {
+    void           *pvProcDir;	/* Cached /proc directory stream */
+    int             iProcFd;	/* and its file descriptor */
+    struct procio_entry_t
+                   *aoEntry;	/* Processes sorted by PID */
+    struct procio_entry_t
+                   *aoSpare;	/* Next scan is merged into this one */
+    size_t          n;		/* Number of entries in aoEntry */
+    size_t          iSize;	/* Allocated entries in both tables */
+    uint64_t        iTimestamp_ns;	/* Time of the last scan */
+    uint64_t        iInterval_ns;	/* Time between the last two scans */
+    uint32_t        iScan;	/* Scans so far */
+} procio_t;
+
+
+#ifdef __cplusplus
+extern          "C" {
+#endif
+
+    int             ProcIoOpen (struct procio_t *procio);
+    /* Prepare the per-process I/O scanner */
+    /* Return 0 on success, -1 otherwise */
+
+    void            ProcIoClose (struct procio_t *procio);
+    /* Release everything held by the scanner */
+
+    int             ProcIoScan (struct procio_t *procio);
+    /* Read the I/O counters of the processes and compute their deltas
+       since their previous read: the active and new processes at every
+       scan, the idle and unreadable ones in turn (see
+       PROCIO_IDLE_SLICES) */
+    /* Return the number of readable processes, -1 on error */
+
+    int             ProcIoTop (const struct procio_t *procio,
+			       const struct procio_entry_t **top, int n);
+    /* Get the n processes with the highest transfer rates over their
+       last interval, most active first */
+    /* Return the number of processes stored into top */
+
+#ifdef __cplusplus
+}				/* extern "C" */
+#endif
+
+#endif				/* _procio_h */
@@ -0,0 +1,183 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+	/* I/O Pressure Stall Information (Linux 4.20 and later) */
+
+#include "psi.h"
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+
+void PsiInit (struct psi_t *p_poPsi)
+{
+    p_poPsi->iFd = p_poPsi->iTriggerFd = -1;
+    memset (&(p_poPsi->oRead), 0, sizeof (p_poPsi->oRead));
+    p_poPsi->oRead.iFd = -1;
+    p_poPsi->oRead.pcBuffer = p_poPsi->acBuffer;
+    p_poPsi->oRead.iSize = sizeof (p_poPsi->acBuffer);
+}				/* PsiInit() */
+
+
+#if defined(__linux__)
+	/**************************************************************/
+	/**************************	Linux	***********************/
+	/**************************************************************/
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#define SYSTEM_PRESSURE	"/proc/pressure/io"
+#define CGROUP2_ROOT	"/sys/fs/cgroup"
+
+int PsiOpen (struct psi_t *p_poPsi, const char *p_pcCgroup)
+{
+    PsiClose (p_poPsi);
+    if (p_pcCgroup && *p_pcCgroup)
+	snprintf (p_poPsi->acPath, sizeof (p_poPsi->acPath),
+		  "%s/%s/io.pressure", CGROUP2_ROOT, p_pcCgroup);
+    else
+	snprintf (p_poPsi->acPath, sizeof (p_poPsi->acPath), "%s",
+		  SYSTEM_PRESSURE);
+    p_poPsi->iFd = p_poPsi->oRead.iFd =
+	open (p_poPsi->acPath, O_RDONLY | O_CLOEXEC);
+    return (p_poPsi->iFd == -1 ? -1 : 0);
+}				/* PsiOpen() */
+
+
+void PsiClose (struct psi_t *p_poPsi)
+{
+    if (p_poPsi->iTriggerFd != -1)
+	close (p_poPsi->iTriggerFd);
+    if (p_poPsi->iFd != -1)
+	close (p_poPsi->iFd);
+    PsiInit (p_poPsi);
+}				/* PsiClose() */
+
+
+static const char *ParseLine (const char *p_pcLine, double *p_prAvg10,
+			      uint64_t * p_piTotal_us)
+	/* "some avg10=0.12 avg60=0.05 avg300=0.01 total=123456" */
+{
+    const char     *pc;
+
+    if ((pc = strstr (p_pcLine, "avg10=")))
+	*p_prAvg10 = strtod (pc + 6, 0);
+    if ((pc = strstr (p_pcLine, "total=")))
+	*p_piTotal_us = strtoull (pc + 6, 0, 10);
+    return (strchr (p_pcLine, '\n'));
+}				/* ParseLine() */
+
+
+int PsiRead (struct psi_t *p_poPsi, struct psi_sample_t *p_poSample)
+{
+    char           *pcBuffer = p_poPsi->acBuffer;
+    const char     *pcLine;
+    ssize_t         n;
+
+    memset (p_poSample, 0, sizeof (*p_poSample));
+    if (p_poPsi->iFd == -1)
+	return (-1);
+    if (p_poPsi->oRead.fReady) {
+	p_poPsi->oRead.fReady = 0;
+	n = p_poPsi->oRead.iLength;
+    }
+    else
+	n = pread (p_poPsi->iFd, pcBuffer, sizeof (p_poPsi->acBuffer) - 1, 0);
+    if (n <= 0)
+	return (-1);
+    pcBuffer[n] = 0;
+    for (pcLine = pcBuffer; pcLine && *pcLine; pcLine++) {
+	if (!strncmp (pcLine, "some ", 5))
+	    pcLine = ParseLine (pcLine, &(p_poSample->rSome10),
+				&(p_poSample->iSomeTotal_us));
+	else if (!strncmp (pcLine, "full ", 5))
+	    pcLine = ParseLine (pcLine, &(p_poSample->rFull10),
+				&(p_poSample->iFullTotal_us));
+	else
+	    pcLine = strchr (pcLine, '\n');
+	if (!pcLine)
+	    break;
+    }
+    return (0);
+}				/* PsiRead() */
+
+
+int PsiArmTrigger (struct psi_t *p_poPsi, uint32_t p_iStall_us,
+		   uint32_t p_iWindow_us)
+	/* A trigger lives as long as its descriptor; unprivileged users
+	   need a window that is a multiple of 2 s */
+{
+    char            acTrigger[64];
+    int             fd;
+
+    if (p_poPsi->iTriggerFd != -1) {
+	close (p_poPsi->iTriggerFd);
+	p_poPsi->iTriggerFd = -1;
+    }
+    if (p_poPsi->iFd == -1)
+	return (-1);
+    fd = open (p_poPsi->acPath, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd == -1)
+	return (-1);
+    snprintf (acTrigger, sizeof (acTrigger), "some %u %u", p_iStall_us,
+	      p_iWindow_us);
+    if (write (fd, acTrigger, strlen (acTrigger) + 1) < 0) {
+	close (fd);
+	return (-1);
+    }
+    p_poPsi->iTriggerFd = fd;
+    return (fd);
+}				/* PsiArmTrigger() */
+
+#else
+	/**************************************************************/
+	/********************	Unsupported platform	***************/
+	/**************************************************************/
+
+int PsiOpen (struct psi_t *p_poPsi, const char *p_pcCgroup)
+{
+    PsiInit (p_poPsi);
+    return (-1);
+}				/* PsiOpen() */
+
+
+void PsiClose (struct psi_t *p_poPsi)
+{
+    PsiInit (p_poPsi);
+}				/* PsiClose() */
+
+
+int PsiRead (struct psi_t *p_poPsi, struct psi_sample_t *p_poSample)
+{
+    memset (p_poSample, 0, sizeof (*p_poSample));
+    return (-1);
+}				/* PsiRead() */
+
+
+int PsiArmTrigger (struct psi_t *p_poPsi, uint32_t p_iStall_us,
+		   uint32_t p_iWindow_us)
+{
+    return (-1);
+}				/* PsiArmTrigger() */
+
+#endif
@@ -0,0 +1,76 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _psi_h
+#define _psi_h
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <inttypes.h>
+
+#include "kread.h"
+
+
+typedef struct psi_t {
+    /* I/O Pressure Stall Information source */
+    int             iFd;	/* Persistent handle, read with pread() */
+    int             iTriggerFd;	/* -1 unless a trigger is armed */
+    char            acPath[192];
+    struct kread_t  oRead;	/* iFd, may be registered into a batch */
+    char            acBuffer[256];
+} psi_t;
+
+typedef struct psi_sample_t {
+    double          rSome10;	/* % of time some tasks stalled (10s) */
+    double          rFull10;	/* % of time all tasks stalled (10s) */
+    uint64_t        iSomeTotal_us;	/* Cumulated stall times */
+    uint64_t        iFullTotal_us;
+} psi_sample_t;
+
+
+#ifdef __cplusplus
+extern          "C" {
+#endif
+
+    void            PsiInit (struct psi_t *psi);
+    /* Initialize an unopened source */
+
+    int             PsiOpen (struct psi_t *psi, const char *cgroup);
+    /* Open the system-wide I/O pressure file, or the io.pressure file of
+       the cgroup2 control group cgroup (relative to the mount point)
+       unless it is NULL or empty */
+    /* Return 0 on success, -1 if PSI is not available */
+
+    void            PsiClose (struct psi_t *psi);
+    /* Close the source and its trigger */
+
+    int             PsiRead (struct psi_t *psi, struct psi_sample_t *sample);
+    /* Parse what a batch read through psi->oRead, or read the file */
+    /* Return 0 on success, -1 on error */
+
+    int             PsiArmTrigger (struct psi_t *psi, uint32_t stall_us,
+				   uint32_t window_us);
+    /* Ask the kernel to wake up a poll() for POLLPRI on the returned
+       descriptor when some tasks stall for stall_us over window_us */
+    /* Return the descriptor to poll, -1 on error */
+
+#ifdef __cplusplus
+}				/* extern "C" */
+#endif
+
+#endif				/* _psi_h */
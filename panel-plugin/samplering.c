@@ -0,0 +1,125 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+	/* Single-writer, multi-reader ring of device samples.
+	   Each record carries a sequence number: the writer zeroes it,
+	   writes the record, then stores its index + 1; a reader checks
+	   it before and after copying the record, and retries from the
+	   oldest record kept when it changed. No lock is taken, so a
+	   slow or stopped reader never holds the writer up. */
+
+#include "samplering.h"
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#define SAMPLERING_MASK	(SAMPLERING_SIZE - 1)
+
+
+void SampleRingInit (struct samplering_t *p_poRing)
+{
+    memset (p_poRing, 0, sizeof (*p_poRing));
+}				/* SampleRingInit() */
+
+
+void SampleRingWrite (struct samplering_t *p_poRing, uint32_t p_iDevice,
+		      uint32_t p_iFlags, const struct devperf_t *p_poPerf)
+{
+    uint64_t        i = p_poRing->iHead;	/* Single writer */
+    struct samplering_record_t *poRecord =
+	p_poRing->aoRecord + (i & SAMPLERING_MASK);
+
+    __atomic_store_n (&(poRecord->seq), 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence (__ATOMIC_RELEASE);
+    poRecord->device = (uint16_t) p_iDevice;
+    poRecord->flags = (uint16_t) p_iFlags;
+    poRecord->qlen = p_poPerf->qlen;
+    poRecord->timestamp_ns = p_poPerf->timestamp_ns;
+    poRecord->rbytes = p_poPerf->rbytes;
+    poRecord->wbytes = p_poPerf->wbytes;
+    poRecord->rbusy_ns = p_poPerf->rbusy_ns;
+    poRecord->wbusy_ns = p_poPerf->wbusy_ns;
+    poRecord->rios = p_poPerf->rios;
+    poRecord->wios = p_poPerf->wios;
+    __atomic_store_n (&(poRecord->seq), i + 1, __ATOMIC_RELEASE);
+    __atomic_store_n (&(p_poRing->iHead), i + 1, __ATOMIC_RELEASE);
+}				/* SampleRingWrite() */
+
+
+void SampleRingAttach (const struct samplering_t *p_poRing,
+		       struct samplering_reader_t *p_poReader,
+		       int p_fBacklog)
+{
+    uint64_t        iHead = __atomic_load_n (&(p_poRing->iHead),
+					     __ATOMIC_ACQUIRE);
+
+    p_poReader->iCursor = iHead;
+    if (p_fBacklog)
+	p_poReader->iCursor -= (iHead < SAMPLERING_SIZE ?
+				iHead : SAMPLERING_SIZE);
+    p_poReader->iSkipped = 0;
+}				/* SampleRingAttach() */
+
+
+int SampleRingRead (const struct samplering_t *p_poRing,
+		    struct samplering_reader_t *p_poReader,
+		    uint32_t *p_piDevice, uint32_t *p_piFlags,
+		    struct devperf_t *p_poPerf)
+{
+    const struct samplering_record_t *poRecord;
+    struct samplering_record_t oRecord;
+    uint64_t        iHead, iCursor, seq;
+
+    for (;;) {
+	iHead = __atomic_load_n (&(p_poRing->iHead), __ATOMIC_ACQUIRE);
+	iCursor = p_poReader->iCursor;
+	if (iCursor == iHead)
+	    return (0);
+	if (iHead - iCursor > SAMPLERING_SIZE) {	/* Lapped */
+	    p_poReader->iSkipped += iHead - SAMPLERING_SIZE - iCursor;
+	    p_poReader->iCursor = iCursor = iHead - SAMPLERING_SIZE;
+	}
+	poRecord = p_poRing->aoRecord + (iCursor & SAMPLERING_MASK);
+	seq = __atomic_load_n (&(poRecord->seq), __ATOMIC_ACQUIRE);
+	if (seq == iCursor + 1) {
+	    memcpy (&oRecord, poRecord, sizeof (oRecord));
+	    __atomic_thread_fence (__ATOMIC_ACQUIRE);
+	    if (__atomic_load_n (&(poRecord->seq), __ATOMIC_RELAXED) == seq)
+		break;
+	}
+	/* Overwritten meanwhile: the next head shows by how much */
+	if (iHead - iCursor == SAMPLERING_SIZE) {
+	    p_poReader->iSkipped++;
+	    p_poReader->iCursor++;
+	}
+    }
+    p_poReader->iCursor++;
+    *p_piDevice = oRecord.device;
+    *p_piFlags = oRecord.flags;
+    p_poPerf->timestamp_ns = oRecord.timestamp_ns;
+    p_poPerf->rbytes = oRecord.rbytes;
+    p_poPerf->wbytes = oRecord.wbytes;
+    p_poPerf->rbusy_ns = oRecord.rbusy_ns;
+    p_poPerf->wbusy_ns = oRecord.wbusy_ns;
+    p_poPerf->rios = oRecord.rios;
+    p_poPerf->wios = oRecord.wios;
+    p_poPerf->qlen = oRecord.qlen;
+    return (1);
+}				/* SampleRingRead() */
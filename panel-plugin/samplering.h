@@ -0,0 +1,97 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef _samplering_h
+#define _samplering_h
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <inttypes.h>
+
+#include "devperf.h"
+
+
+#define SAMPLERING_SIZE	1024	/* Records kept, a power of 2 */
+
+#define SAMPLERING_BASELINE	0x0001
+/* Record flag: the sample does not follow the previous one of the
+   device (first sample, device unavailable meanwhile, counters reset) */
+
+
+typedef struct samplering_record_t {
+    uint64_t        seq;	/* Index + 1 once written, 0 while written */
+    uint16_t        device;	/* Index given by the writer */
+    uint16_t        flags;	/* SAMPLERING_* */
+    int32_t         qlen;
+    uint64_t        timestamp_ns;
+    uint64_t        rbytes;
+    uint64_t        wbytes;
+    uint64_t        rbusy_ns;
+    uint64_t        wbusy_ns;
+    uint64_t        rios;
+    uint64_t        wios;
+} samplering_record_t;
+
+typedef struct samplering_t {
+    /* Samples of one writer, read by any number of readers at their
+       own pace: the writer never waits for a reader, a reader lapped by
+       the writer skips to the oldest record still kept */
+    uint64_t        iHead;	/* Records written since the start */
+    struct samplering_record_t
+                    aoRecord[SAMPLERING_SIZE];
+} samplering_t;
+
+typedef struct samplering_reader_t {
+    uint64_t        iCursor;	/* Index of the next record to read */
+    uint64_t        iSkipped;	/* Records overwritten before read */
+} samplering_reader_t;
+
+
+#ifdef __cplusplus
+extern          "C" {
+#endif
+
+    void            SampleRingInit (struct samplering_t *ring);
+    /* Empty the ring; its readers must be attached again */
+
+    void            SampleRingWrite (struct samplering_t *ring,
+				     uint32_t device, uint32_t flags,
+				     const struct devperf_t *perf);
+    /* Append a sample of device (below 65536), overwriting the oldest
+       record once full (single writer) */
+
+    void            SampleRingAttach (const struct samplering_t *ring,
+				      struct samplering_reader_t *reader,
+				      int fBacklog);
+    /* Start reading at the oldest record kept if fBacklog, at the next
+       one to be written otherwise */
+
+    int             SampleRingRead (const struct samplering_t *ring,
+				    struct samplering_reader_t *reader,
+				    uint32_t *device, uint32_t *flags,
+				    struct devperf_t *perf);
+    /* Get the next record of the reader, skipping what the writer
+       overwrote meanwhile (counted in reader->iSkipped) */
+    /* Return 1 if a record was read, 0 if the reader is up to date */
+
+#ifdef __cplusplus
+}				/* extern "C" */
+#endif
+
+#endif				/* _samplering_h */
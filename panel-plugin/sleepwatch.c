@@ -0,0 +1,65 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+	/* Suspend detection without any daemon: CLOCK_MONOTONIC stops
+	   while the system sleeps, CLOCK_BOOTTIME (Linux) does not */
+
+#include "sleepwatch.h"
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <time.h>
+
+
+static int64_t AsleepNow_ns (void)
+	/* Return the time slept since boot, -1 if unknown */
+{
+#if defined(CLOCK_BOOTTIME)
+    struct timespec oBoot, oMonotonic;
+
+    if (clock_gettime (CLOCK_MONOTONIC, &oMonotonic)
+	|| clock_gettime (CLOCK_BOOTTIME, &oBoot))
+	return (-1);
+    return ((int64_t) (oBoot.tv_sec - oMonotonic.tv_sec) * 1000000000 +
+	    (oBoot.tv_nsec - oMonotonic.tv_nsec));
+#else
+    return (-1);
+#endif
+}				/* AsleepNow_ns() */
+
+
+void SleepWatchInit (struct sleepwatch_t *p_poWatch)
+{
+    p_poWatch->iAsleep_ns = AsleepNow_ns ();
+}				/* SleepWatchInit() */
+
+
+uint64_t SleepWatchCheck (struct sleepwatch_t *p_poWatch)
+{
+    int64_t         iAsleep_ns, iSlept_ns;
+
+    if (p_poWatch->iAsleep_ns < 0)
+	return (0);
+    iAsleep_ns = AsleepNow_ns ();
+    iSlept_ns = iAsleep_ns - p_poWatch->iAsleep_ns;
+    if (iSlept_ns < SLEEPWATCH_MIN_NS)
+	return (0);
+    p_poWatch->iAsleep_ns = iAsleep_ns;
+    return (iSlept_ns);
+}				/* SleepWatchCheck() */
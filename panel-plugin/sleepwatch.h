@@ -0,0 +1,54 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#ifndef _sleepwatch_h
+#define _sleepwatch_h
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <inttypes.h>
+
+
+#define SLEEPWATCH_MIN_NS	500000000
+/* Smaller differences are clock adjustments, not sleeps */
+
+typedef struct sleepwatch_t {
+    /* Time the system spent suspended, as the difference between a
+       clock that counts it (CLOCK_BOOTTIME) and one that does not
+       (CLOCK_MONOTONIC) */
+    int64_t         iAsleep_ns;	/* -1 if unavailable on this system */
+} sleepwatch_t;
+
+
+#ifdef __cplusplus
+extern          "C" {
+#endif
+
+    void            SleepWatchInit (struct sleepwatch_t *watch);
+    /* Start watching from now */
+
+    uint64_t        SleepWatchCheck (struct sleepwatch_t *watch);
+    /* Return how long the system slept since the previous call (or
+       SleepWatchInit()), 0 if it did not or if it cannot be told */
+
+#ifdef __cplusplus
+}				/* extern "C" */
+#endif
+
+#endif				/* _sleepwatch_h */
@@ -0,0 +1,27 @@
+#!/bin/sh
+#
+# Replay the recorded counter sequences tests/*.rec through
+# diskperf-cli -r and compare the rates, busy times and bar fractions
+# with tests/*.out
+#
+
+srcdir=${srcdir:-.}
+CLI=${CLI:-./diskperf-cli}
+
+case `uname -s` in
+    NetBSD|SunOS)
+	# Only a total busy time: the read/write split is estimated
+	exit 77 ;;
+esac
+
+status=0
+for rec in $srcdir/tests/*.rec; do
+    out=`echo $rec | sed 's/\.rec$/.out/'`
+    if $CLI -r $rec | diff -u $out -; then
+	echo "PASS: `basename $rec`"
+    else
+	echo "FAIL: `basename $rec`"
+	status=1
+    fi
+done
+exit $status
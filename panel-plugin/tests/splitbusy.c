@@ -0,0 +1,202 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+	/* Check of PerfStatsSplitBusy(): synthetic intervals of a device
+	   whose busy time is COST_OP per I/O operation plus COST_MIB per
+	   MiB, with a varying read/write mix and NOISE on the measured
+	   total. Once WARMUP intervals are learnt, the estimated read busy
+	   time must stay within MAX_ERROR busy points of the exact one.
+	   Then the degenerate cases: only reads, only writes (exact split
+	   with or without a fit), and intervals that never vary the bytes
+	   per operation, which leave the fit singular (no NaN, the fallback
+	   split of the operations and bytes shares). */
+
+#include "perfstats.h"
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#define COST_OP		0.2	/* Busy % per I/O operation per second
+				   (2 ms) */
+#define COST_MIB	0.8	/* Busy % per MiB/s (8 ms per MiB) */
+#define NOISE		0.02	/* Relative error of the measured total */
+#define INTERVALS	500
+#define WARMUP		20
+#define MAX_ERROR	0.5	/* Busy % */
+
+static int      m_nFailures = 0;
+
+
+static double Random (void)
+	/* Deterministic uniform [0, 1[ (LCG), so that a failure always
+	   reproduces */
+{
+    static uint32_t i = 1;
+
+    i = i * 1664525 + 1013904223;
+    return ((i >> 8) / 16777216.0);
+}				/* Random() */
+
+
+static void SetInterval (struct perfstats_t *p_poStats, double p_rRIops,
+			 double p_rRMiB, double p_rWIops, double p_rWMiB,
+			 double p_rBusy)
+	/* Statistics of an interval whose total busy time only is
+	   known */
+{
+    memset (p_poStats, 0, sizeof (*p_poStats));
+    p_poStats->arIops[R_DATA] = p_rRIops;
+    p_poStats->arIops[W_DATA] = p_rWIops;
+    p_poStats->arIops[RW_DATA] = p_rRIops + p_rWIops;
+    p_poStats->arPerf[R_DATA] = p_rRMiB;
+    p_poStats->arPerf[W_DATA] = p_rWMiB;
+    p_poStats->arPerf[RW_DATA] = p_rRMiB + p_rWMiB;
+    p_poStats->arBusy[RW_DATA] = p_rBusy;
+    p_poStats->fBusyValid = 1;
+}				/* SetInterval() */
+
+
+static void Check (int p_fOk, const char *p_pcName, double p_rGot,
+		   double p_rExpected)
+{
+    if (p_fOk)
+	printf ("PASS: %s\n", p_pcName);
+    else {
+	printf ("FAIL: %s: got %g, expected %g\n", p_pcName, p_rGot,
+		p_rExpected);
+	m_nFailures++;
+    }
+}				/* Check() */
+
+
+static void CheckMix (void)
+	/* Varying mix: the fit has to find the costs back */
+{
+    struct busysplit_t oFit;
+    struct perfstats_t oStats;
+    double          rRIops, rRMiB, rWIops, rWMiB, rRead, rWrite, rError,
+	rMaxError = 0, rWorst = 0, rExpected = 0;
+    int             i;
+
+    memset (&oFit, 0, sizeof (oFit));
+    for (i = 0; i < INTERVALS; i++) {
+	/* 4 to 128 KiB per operation */
+	rRIops = 100 * Random ();
+	rRMiB = rRIops * (4 + 124 * Random ()) / 1024;
+	rWIops = 100 * Random ();
+	rWMiB = rWIops * (4 + 124 * Random ()) / 1024;
+	rRead = COST_OP * rRIops + COST_MIB * rRMiB;
+	rWrite = COST_OP * rWIops + COST_MIB * rWMiB;
+	SetInterval (&oStats, rRIops, rRMiB, rWIops, rWMiB,
+		     (rRead + rWrite) * (1 + NOISE * (2 * Random () - 1)));
+	PerfStatsSplitBusy (&oFit, &oStats);
+	if (i < WARMUP)
+	    continue;
+	/* The estimate splits the measured total: compare the shares */
+	rError = fabs (oStats.arBusy[R_DATA] - oStats.arBusy[RW_DATA] *
+		       rRead / (rRead + rWrite));
+	if (!(rError <= rMaxError)) {
+	    rMaxError = rError;
+	    rWorst = oStats.arBusy[R_DATA];
+	    rExpected = oStats.arBusy[RW_DATA] * rRead / (rRead + rWrite);
+	}
+    }
+    Check (rMaxError <= MAX_ERROR, "mixed reads and writes", rWorst,
+	   rExpected);
+}				/* CheckMix() */
+
+
+static void CheckOneWay (int p_fRead, int p_fFit)
+	/* Only reads, or only writes: all of the busy time is theirs */
+{
+    struct busysplit_t oFit;
+    struct perfstats_t oStats;
+    double          rIops, rMiB, rBusy, rError, rMaxError = 0, rWorst = 0;
+    char            acName[64];
+    int             i;
+
+    memset (&oFit, 0, sizeof (oFit));
+    for (i = 0; i < INTERVALS; i++) {
+	rIops = 100 * Random ();
+	rMiB = rIops * (4 + 124 * Random ()) / 1024;
+	rBusy = COST_OP * rIops + COST_MIB * rMiB;
+	if (p_fRead)
+	    SetInterval (&oStats, rIops, rMiB, 0, 0, rBusy);
+	else
+	    SetInterval (&oStats, 0, 0, rIops, rMiB, rBusy);
+	PerfStatsSplitBusy (p_fFit ? &oFit : NULL, &oStats);
+	rError = fabs (oStats.arBusy[p_fRead ? R_DATA : W_DATA] - rBusy) +
+	    fabs (oStats.arBusy[p_fRead ? W_DATA : R_DATA]);
+	if (!(rError <= rMaxError)) {
+	    rMaxError = rError;
+	    rWorst = oStats.arBusy[p_fRead ? R_DATA : W_DATA];
+	}
+    }
+    snprintf (acName, sizeof (acName), "%s only, %s", p_fRead ?
+	      "reads" : "writes", p_fFit ? "fit" : "no fit");
+    Check (rMaxError <= 1e-9, acName, rWorst, rBusy);
+}				/* CheckOneWay() */
+
+
+static void CheckSingular (void)
+	/* 64 KiB per operation in both directions: the operations and
+	   bytes sums are collinear, the fit cannot be solved */
+{
+    struct busysplit_t oFit;
+    struct perfstats_t oStats;
+    double          rRIops, rWIops, rBusy, rExpected, rError,
+	rMaxError = 0, rWorst = 0, rWorstExpected = 0;
+    int             i;
+
+    memset (&oFit, 0, sizeof (oFit));
+    for (i = 0; i < INTERVALS; i++) {
+	rRIops = 100 * Random ();
+	rWIops = 100 * Random ();
+	rBusy = (COST_OP + COST_MIB / 16) * (rRIops + rWIops);
+	SetInterval (&oStats, rRIops, rRIops / 16, rWIops, rWIops / 16,
+		     rBusy);
+	PerfStatsSplitBusy (&oFit, &oStats);
+	/* Same share of the operations and of the bytes */
+	rExpected = (rRIops + rWIops > 0) ?
+	    rBusy * rRIops / (rRIops + rWIops) : 0;
+	rError = fabs (oStats.arBusy[R_DATA] - rExpected) +
+	    fabs (oStats.arBusy[R_DATA] + oStats.arBusy[W_DATA] - rBusy);
+	if (!(rError <= rMaxError)) {
+	    rMaxError = rError;
+	    rWorst = oStats.arBusy[R_DATA];
+	    rWorstExpected = rExpected;
+	}
+    }
+    Check (rMaxError <= 1e-9, "singular fit", rWorst, rWorstExpected);
+}				/* CheckSingular() */
+
+
+int main (void)
+{
+    CheckMix ();
+    CheckOneWay (1, 0);
+    CheckOneWay (1, 1);
+    CheckOneWay (0, 0);
+    CheckOneWay (0, 1);
+    CheckSingular ();
+    return (m_nFailures ? 1 : 0);
+}				/* main() */
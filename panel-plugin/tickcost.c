@@ -0,0 +1,91 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+	/* Self-instrumentation: what the monitor itself costs per
+	   update period */
+
+#include "tickcost.h"
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+#include <time.h>
+
+
+uint64_t TickCostNow_ns (void)
+{
+    struct timespec oNow;
+
+    clock_gettime (CLOCK_MONOTONIC, &oNow);
+    return ((uint64_t) 1000 * 1000 * 1000 * oNow.tv_sec + oNow.tv_nsec);
+}				/* TickCostNow_ns() */
+
+
+void TickCostInit (struct tickcost_t *p_poCost)
+{
+    memset (p_poCost, 0, sizeof (*p_poCost));
+}				/* TickCostInit() */
+
+
+void TickCostAdd (struct tickcost_t *p_poCost,
+		  const struct tickcost_sample_t *p_poSample)
+{
+    p_poCost->aoSample[p_poCost->iNext] = *p_poSample;
+    p_poCost->iNext = (p_poCost->iNext + 1) % TICKCOST_WINDOW;
+    if (p_poCost->n < TICKCOST_WINDOW)
+	p_poCost->n++;
+}				/* TickCostAdd() */
+
+
+#define MAX(a, b)	((a) > (b) ? (a) : (b))
+
+int TickCostSummary (const struct tickcost_t *p_poCost,
+		     struct tickcost_sample_t *p_poAverage,
+		     struct tickcost_sample_t *p_poMaximum)
+{
+    const struct tickcost_sample_t *poSample;
+    struct tickcost_sample_t oSum;
+    int             i;
+
+    memset (&oSum, 0, sizeof (oSum));
+    memset (p_poMaximum, 0, sizeof (*p_poMaximum));
+    for (i = 0; i < p_poCost->n; i++) {
+	poSample = p_poCost->aoSample + i;
+	oSum.collect_ns += poSample->collect_ns;
+	oSum.parse_ns += poSample->parse_ns;
+	oSum.render_ns += poSample->render_ns;
+	oSum.syscalls += poSample->syscalls;
+	p_poMaximum->collect_ns =
+	    MAX (p_poMaximum->collect_ns, poSample->collect_ns);
+	p_poMaximum->parse_ns =
+	    MAX (p_poMaximum->parse_ns, poSample->parse_ns);
+	p_poMaximum->render_ns =
+	    MAX (p_poMaximum->render_ns, poSample->render_ns);
+	p_poMaximum->syscalls =
+	    MAX (p_poMaximum->syscalls, poSample->syscalls);
+    }
+    memset (p_poAverage, 0, sizeof (*p_poAverage));
+    if (p_poCost->n) {
+	p_poAverage->collect_ns = oSum.collect_ns / p_poCost->n;
+	p_poAverage->parse_ns = oSum.parse_ns / p_poCost->n;
+	p_poAverage->render_ns = oSum.render_ns / p_poCost->n;
+	p_poAverage->syscalls = oSum.syscalls / p_poCost->n;
+    }
+    return (p_poCost->n);
+}				/* TickCostSummary() */
@@ -0,0 +1,70 @@
+/* Copyright (c) 2026 The Xfce development team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+#ifndef _tickcost_h
+#define _tickcost_h
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <inttypes.h>
+
+
+#define TICKCOST_WINDOW	64	/* Number of periods summarised */
+
+
+typedef struct tickcost_sample_t {
+    /* Cost of a single update period */
+    uint64_t        collect_ns;	/* Getting the kernel statistics */
+    uint64_t        parse_ns;	/* Part of collect_ns spent parsing */
+    uint64_t        render_ns;	/* Displaying the results */
+    uint32_t        syscalls;	/* System calls issued */
+} tickcost_sample_t;
+
+typedef struct tickcost_t {
+    struct tickcost_sample_t
+                    aoSample[TICKCOST_WINDOW];
+    int             iNext;	/* Next slot of aoSample[] */
+    int             n;		/* Number of valid samples */
+} tickcost_t;
+
+
+#ifdef __cplusplus
+extern          "C" {
+#endif
+
+    uint64_t        TickCostNow_ns (void);
+    /* Return the CLOCK_MONOTONIC time, in ns */
+
+    void            TickCostInit (struct tickcost_t *cost);
+
+    void            TickCostAdd (struct tickcost_t *cost,
+				 const struct tickcost_sample_t *sample);
+    /* Record the cost of one period, dropping the oldest one once
+       the window is full */
+
+    int             TickCostSummary (const struct tickcost_t *cost,
+				     struct tickcost_sample_t *average,
+				     struct tickcost_sample_t *maximum);
+    /* Compute the average and the maximum costs over the window */
+    /* Return the number of periods summarised */
+
+#ifdef __cplusplus
+}				/* extern "C" */
+#endif
+
+#endif				/* _tickcost_h */